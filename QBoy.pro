@@ -8,7 +8,7 @@
 #
 # QMake Settings, 1
 #
-QT         += core opengl
+QT         += core opengl concurrent
 TARGET      = QBoy
 TEMPLATE    = lib
 CONFIG     += c++11
@@ -38,13 +38,40 @@ HEADERS += \
     include/QBoy/Config.hpp \
     include/QBoy/Core/RomInfo.hpp \
     include/QBoy/Core/RomErrors.hpp \
+    include/QBoy/Core/RomCache.hpp \
     include/QBoy/Core/Lz77.hpp \
+    include/QBoy/Core/Lz77Errors.hpp \
+    include/QBoy/Core/Rle.hpp \
+    include/QBoy/Core/Huffman.hpp \
+    include/QBoy/Core/Diff.hpp \
+    include/QBoy/Core/Compression.hpp \
     include/QBoy/Graphics/Palette.hpp \
     include/QBoy/Graphics/Color.hpp \
     include/QBoy/Graphics/PaletteErrors.hpp \
     include/QBoy/Graphics/Image.hpp \
+    include/QBoy/Graphics/TileCodec.hpp \
+    src/Graphics/Parallel.hpp \
+    include/QBoy/Graphics/Tileset.hpp \
+    include/QBoy/Graphics/Tilemap.hpp \
+    include/QBoy/Graphics/TilemapErrors.hpp \
+    include/QBoy/Graphics/SoftwareRenderer.hpp \
+    include/QBoy/Graphics/RendererErrors.hpp \
+    include/QBoy/Graphics/AffineBackground.hpp \
+    include/QBoy/Graphics/SpriteSheet.hpp \
+    include/QBoy/Graphics/PngWriter.hpp \
+    include/QBoy/Graphics/PngErrors.hpp \
+    include/QBoy/Graphics/ImageImporter.hpp \
+    include/QBoy/Graphics/ImportErrors.hpp \
+    include/QBoy/Graphics/Quantizer.hpp \
+    include/QBoy/Graphics/QuantizerErrors.hpp \
+    include/QBoy/Graphics/Remapper.hpp \
+    include/QBoy/Graphics/RemapperErrors.hpp \
+    src/Graphics/NearestColor.hpp \
+    include/QBoy/Graphics/ColorCodec.hpp \
+    include/QBoy/Graphics/PalettePool.hpp \
     include/QBoy/OpenGL/IndexedTexture.hpp \
     include/QBoy/OpenGL/GLErrors.hpp \
+    include/QBoy/OpenGL/PaletteBank.hpp \
     include/QBoy/Graphics/ImageErrors.hpp
 
 #
@@ -53,11 +80,29 @@ HEADERS += \
 SOURCES += \
     src/Core/RomInfo.cpp \
     src/Core/Rom.cpp \
+    src/Core/RomCache.cpp \
     src/Core/Lz77.cpp \
+    src/Core/Rle.cpp \
+    src/Core/Huffman.cpp \
+    src/Core/Diff.cpp \
+    src/Core/Compression.cpp \
     src/Graphics/Palette.cpp \
     src/OpenGL/GLErrors.cpp \
     src/OpenGL/IndexedTexture.cpp \
-    src/Graphics/Image.cpp
+    src/OpenGL/PaletteBank.cpp \
+    src/Graphics/Image.cpp \
+    src/Graphics/TileCodec.cpp \
+    src/Graphics/Tileset.cpp \
+    src/Graphics/Tilemap.cpp \
+    src/Graphics/SoftwareRenderer.cpp \
+    src/Graphics/AffineBackground.cpp \
+    src/Graphics/SpriteSheet.cpp \
+    src/Graphics/PngWriter.cpp \
+    src/Graphics/ImageImporter.cpp \
+    src/Graphics/Quantizer.cpp \
+    src/Graphics/Remapper.cpp \
+    src/Graphics/ColorCodec.cpp \
+    src/Graphics/PalettePool.cpp
 
 
 #
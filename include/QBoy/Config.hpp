@@ -54,6 +54,14 @@ namespace qboy
     #   else
     #       define QBOY_RELEASE
     #   endif
+
+    #   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #       define QBOY_SSE2
+    #   endif
+
+    #   if defined(__AVX2__)
+    #       define QBOY_AVX2
+    #   endif
 }
 
 
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_COMPRESSION_HPP__
+#define __QBOY_COMPRESSION_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the data formats of the GBA BIOS.
+    ///
+    /// The values equal the first byte of the data header.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum CompressionType : int
+    {
+        CT_None     = 0x00,
+        CT_Lz77     = 0x10,
+        CT_Huffman4 = 0x24,
+        CT_Huffman8 = 0x28,
+        CT_Rle      = 0x30,
+        CT_Diff8    = 0x81,
+        CT_Diff16   = 0x82
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Compression.hpp
+    /// \brief  Handles all data formats of the GBA BIOS.
+    ///
+    /// Decodes data of any supported format by looking at its
+    /// header and chooses the best format for new data.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Compression {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Determines the format of the data at an offset.
+        /// \returns the format; CT_None if not recognized.
+        ///
+        ///////////////////////////////////////////////////////////
+        static CompressionType type(const Rom &rom, UInt32 offset);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decodes the data at the given offset.
+        ///
+        /// Determines the format by the header of the data and
+        /// decodes it with the corresponding codec.
+        ///
+        /// \param rom Rom to read the data from
+        /// \param offset Offset to read data within rom from
+        /// \param size Outputs the encoded data size
+        /// \returns the decoded raw data; null on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const Rom &rom, UInt32 offset, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decodes data within a byte array.
+        /// \param data Byte array starting with the encoded data
+        /// \param size Outputs the encoded data size
+        /// \returns the decoded raw data; null on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const QByteArray &data, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Encodes the data in the given format.
+        /// \param raw QByteArray to encode
+        /// \param type Format to encode the data in
+        /// \returns the encoded data; null on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compress(const QByteArray &raw, CompressionType type);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Encodes the data in the smallest format.
+        ///
+        /// Compresses the data with LZ77, RLE and 4-bit and 8-bit
+        /// Huffman on separate threads, verifies each result by
+        /// decoding it and returns the smallest one. On a tie,
+        /// the format listed first wins. Differential filters
+        /// are not considered, as they do not reduce the size.
+        ///
+        /// \param raw QByteArray to compress
+        /// \param type Outputs the chosen format
+        /// \returns the smallest encoded data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compressBest(const QByteArray &raw, CompressionType *type);
+    };
+}
+
+
+#endif  // __QBOY_COMPRESSION_HPP__
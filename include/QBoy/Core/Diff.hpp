@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_DIFF_HPP__
+#define __QBOY_DIFF_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Diff.hpp
+    /// \brief  Applies or removes differential filters.
+    ///
+    /// Handles the 8-bit (type 0x81) and 16-bit (type 0x82)
+    /// differential filters understood by the DiffUnFilter
+    /// functions of the GBA BIOS. Filtered data is not smaller
+    /// than the raw data, but usually compresses better.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Diff {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Removes the filter of the data at an offset.
+        /// \param rom Rom to read the filtered data from
+        /// \param offset Offset to read data within rom from
+        /// \param size Outputs the filtered data size
+        /// \returns the unfiltered raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray unfilter(const Rom &rom, UInt32 offset, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Removes the filter of data within a byte array.
+        /// \param data Byte array starting with the filtered data
+        /// \param size Outputs the filtered data size
+        /// \returns the unfiltered raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray unfilter(const QByteArray &data, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Replaces every unit by its difference to the
+        /// previous one.
+        /// \param raw QByteArray to filter
+        /// \param bits Size of one data unit; either 8 or 16
+        /// \returns the filtered data; null if the data length
+        /// is not a multiple of the unit size.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray filter(const QByteArray &raw, Int32 bits = 8);
+    };
+}
+
+
+#endif  // __QBOY_DIFF_HPP__
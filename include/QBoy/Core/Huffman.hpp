@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_HUFFMAN_HPP__
+#define __QBOY_HUFFMAN_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Huffman.hpp
+    /// \brief  Compresses or decompresses Huffman data.
+    ///
+    /// Handles the 4-bit (type 0x24) and 8-bit (type 0x28)
+    /// Huffman encoding understood by the HuffUnComp function
+    /// of the GBA BIOS.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Huffman {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses Huffman data at the given offset.
+        /// \param rom Rom to read Huffman data from
+        /// \param offset Offset to read data within rom from
+        /// \param size Outputs the compressed data size
+        /// \returns the uncompressed raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const Rom &rom, UInt32 offset, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses Huffman data within a byte array.
+        /// \param data Byte array starting with the Huffman data
+        /// \param size Outputs the compressed data size
+        /// \returns the uncompressed raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const QByteArray &data, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Compresses the given raw data to Huffman data.
+        ///
+        /// Builds the Huffman tree of all 4-bit or 8-bit units
+        /// within the data and encodes them. The BIOS limits the
+        /// distance between a node and its children, therefore
+        /// the compression fails in the rare case that the tree
+        /// can not be stored; a null QByteArray is returned.
+        ///
+        /// \param raw QByteArray to compress to Huffman data
+        /// \param bits Size of one data unit; either 4 or 8
+        /// \returns the compressed Huffman data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compress(const QByteArray &raw, Int32 bits = 8);
+    };
+}
+
+
+#endif  // __QBOY_HUFFMAN_HPP__
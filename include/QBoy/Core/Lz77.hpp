@@ -29,10 +29,52 @@
 //
 ///////////////////////////////////////////////////////////
 #include <QBoy/Core/Rom.hpp>
+#include <QString>
+#include <QVector>
+#include <functional>
 
 
 namespace qboy
 {
+    ///////////////////////////////////////////////////////////
+    /// \brief Encoder state at the start of an LZ77 block.
+    ///
+    /// Holds the positions within the raw and the compressed
+    /// data at which a flag block begins. The encoder can be
+    /// restarted at any of these positions.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct Lz77Checkpoint
+    {
+        Int32 input;
+        Int32 output;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Describes one result of a batch decompression.
+    ///
+    /// Holds the location of the decompressed data within the
+    /// output buffer, the size of the compressed data and an
+    /// error string, which is null if decompressing succeeded.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct Lz77Entry
+    {
+        Int32 offset;
+        Int32 length;
+        Int32 size;
+        QString error;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Receives one decoded tile and its index.
+    ///
+    ///////////////////////////////////////////////////////////
+    typedef std::function<void(const UInt8 *tile, Int32 index)> Lz77TileFunc;
+
+
     ///////////////////////////////////////////////////////////
     /// \author Pokedude
     /// \date   06/05/2016
@@ -49,7 +91,8 @@ namespace qboy
         /// Attempts to decompress the LZ77 data at the specified
         /// offset and returns it in a QByteArray. Also outputs
         /// the size of the compressed data in order to implement
-        /// repointing features.
+        /// repointing features. The result is kept in the cache
+        /// of the rom, so repeated calls do not decode again.
         ///
         /// \param rom Rom to read LZ77 data from
         /// \param offset Offset to read data within rom from
@@ -59,17 +102,165 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         static QByteArray decompress(const Rom &rom, UInt32 offset, Int32 *size);
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses LZ77 data within a byte array.
+        /// \param data Byte array starting with the LZ77 data
+        /// \param size Outputs the compressed data size
+        /// \returns the uncompressed raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const QByteArray &data, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses LZ77 data tile by tile.
+        ///
+        /// Passes every tile to the given function as soon as it
+        /// is decoded, while it is still in the CPU cache. The
+        /// last tile is padded with zeroes. By default, the data
+        /// is decoded in full and kept in the cache of the rom.
+        /// Data that exceeds the cache budget, or any data if
+        /// caching is not requested, is decoded into a small ring
+        /// buffer and never held completely in memory.
+        ///
+        /// \param rom Rom to read LZ77 data from
+        /// \param offset Offset to read data within rom from
+        /// \param tileSize Size of one tile in bytes; 32 or 64
+        /// \param func Function to receive the tiles
+        /// \param size Outputs the compressed data size
+        /// \param cache Keep the decoded data in the rom cache?
+        /// \returns the uncompressed size; -1 on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        static Int32 decompressTiles(const Rom &rom, UInt32 offset, Int32 tileSize, const Lz77TileFunc &func, Int32 *size, Boolean cache = true);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads the uncompressed size from the header.
+        /// \param rom Rom to read LZ77 data from
+        /// \param offset Offset to read data within rom from
+        /// \returns the uncompressed size; -1 if no LZ77 data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static Int32 decompressedSize(const Rom &rom, UInt32 offset);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses LZ77 data at many offsets at once.
+        ///
+        /// Reads the headers of all entries first, then decodes
+        /// the data on multiple cores directly into one buffer.
+        /// The entries are output in the order of the offsets;
+        /// failed entries have a length of zero and an error.
+        ///
+        /// \param rom Rom to read LZ77 data from
+        /// \param offsets Offsets to read data within rom from
+        /// \param entries Outputs the location of each result
+        /// \returns the buffer holding all uncompressed data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompressMany(const Rom &rom, const QList<UInt32> &offsets, QVector<Lz77Entry> *entries);
+
         ///////////////////////////////////////////////////////////
         /// \brief Compresses the given raw data to LZ77 data.
         ///
         /// Attempts to compress the LZ77 data and returns the
-        /// compressed data in a QByteArray.
+        /// compressed data in a QByteArray. Optionally outputs
+        /// the encoder checkpoints for qboy::Lz77::recompress.
+        ///
+        /// \param array QByteArray to compress to LZ77 data
+        /// \param checkpoints Outputs the encoder checkpoints
+        /// \returns the compressed LZ77 data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compress(const QByteArray &raw, QVector<Lz77Checkpoint> *checkpoints = NULL);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Compresses the given raw data on multiple cores.
+        ///
+        /// Splits the data into segments of 8KB and searches each
+        /// segment for matches on a separate thread. The result
+        /// is identical to qboy::Lz77::compress, regardless of
+        /// the amount of threads used.
         ///
         /// \param array QByteArray to compress to LZ77 data
+        /// \param checkpoints Outputs the encoder checkpoints
+        /// \returns the compressed LZ77 data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compressParallel(const QByteArray &raw, QVector<Lz77Checkpoint> *checkpoints = NULL);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Compresses the given raw data directly into rom.
+        ///
+        /// Streams the compressed data to the given offset without
+        /// an intermediate buffer. The first bytes up to reserved
+        /// may be overwritten; beyond that, the data may only grow
+        /// into free space (0xFF bytes). If it runs out of space,
+        /// all bytes written are restored and false is returned.
+        /// On success, the rom offset is placed after the data.
+        ///
+        /// \param rom Rom to write the LZ77 data to
+        /// \param offset Offset to write data within rom to
+        /// \param raw QByteArray to compress to LZ77 data
+        /// \param reserved Amount of bytes that may be overwritten
+        /// \param size Outputs the compressed data size
+        /// \returns false if the data did not fit.
+        ///
+        ///////////////////////////////////////////////////////////
+        static bool compressInto(Rom &rom, UInt32 offset, const QByteArray &raw, Int32 reserved, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Writes already compressed data into the rom.
+        ///
+        /// Follows the rules of qboy::Lz77::compressInto: the first
+        /// bytes up to reserved may be overwritten, the rest must
+        /// be free space (0xFF bytes). The rom is not modified if
+        /// the data does not fit.
+        ///
+        /// \param rom Rom to write the LZ77 data to
+        /// \param offset Offset to write data within rom to
+        /// \param data Compressed data to write
+        /// \param reserved Amount of bytes that may be overwritten
+        /// \returns false if the data did not fit.
+        ///
+        ///////////////////////////////////////////////////////////
+        static bool writeInto(Rom &rom, UInt32 offset, const QByteArray &data, Int32 reserved);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Compresses data that was modified slightly.
+        ///
+        /// Reuses the compressed data of the previous version up
+        /// to the last checkpoint before the first modified byte
+        /// and re-encodes from there on. As soon as the encoder
+        /// is far enough past the last modified byte, the rest
+        /// of the previous output is reused as well. The result
+        /// is identical to qboy::Lz77::compress.
+        ///
+        /// \param raw The modified raw data
+        /// \param previous The raw data that was compressed last
+        /// \param encoded The compressed data of previous
+        /// \param checkpoints Checkpoints of encoded; get updated
         /// \returns the compressed LZ77 data.
         ///
         ///////////////////////////////////////////////////////////
-        static QByteArray compress(const QByteArray &raw);
+        static QByteArray recompress(
+                const QByteArray &raw,
+                const QByteArray &previous,
+                const QByteArray &encoded,
+                QVector<Lz77Checkpoint> *checkpoints
+        );
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Estimates the size of the compressed data.
+        ///
+        /// Returns an upper bound of the size that compressing
+        /// the given amount of bytes may yield, without actually
+        /// compressing anything. Useful to quickly determine
+        /// whether data fits into an existing location.
+        ///
+        /// \param length Length of the uncompressed data
+        /// \returns the maximum compressed size, aligned to four.
+        ///
+        ///////////////////////////////////////////////////////////
+        static Int32 estimateSize(Int32 length);
     };
 }
 
@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_LZ77ERRORS_HPP__
+#define __QBOY_LZ77ERRORS_HPP__
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Lz77Errors.hpp
+    /// \brief  Defines errors of the LZ77 codec.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    #define LZ77_ERROR_HEADER   "The offset is out of rom range or does not point to LZ77 data."
+    #define LZ77_ERROR_DATA     "The LZ77 data is broken."
+    #define LZ77_ERROR_ARENA    "The decompressed data exceeds the size of the output buffer."
+}
+
+
+#endif  // __QBOY_LZ77ERRORS_HPP__
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_RLE_HPP__
+#define __QBOY_RLE_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Rle.hpp
+    /// \brief  Compresses or decompresses run-length data.
+    ///
+    /// Handles the run-length encoding (type 0x30) that is
+    /// understood by the RLUnComp functions of the GBA BIOS.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Rle {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses RLE data at the given offset.
+        /// \param rom Rom to read RLE data from
+        /// \param offset Offset to read data within rom from
+        /// \param size Outputs the compressed data size
+        /// \returns the uncompressed raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const Rom &rom, UInt32 offset, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decompresses RLE data within a byte array.
+        /// \param data Byte array starting with the RLE data
+        /// \param size Outputs the compressed data size
+        /// \returns the uncompressed raw data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray decompress(const QByteArray &data, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Compresses the given raw data to RLE data.
+        ///
+        /// Runs of three to 130 equal bytes are stored as two
+        /// bytes, everything else is copied in chunks of up to
+        /// 128 bytes.
+        ///
+        /// \param raw QByteArray to compress to RLE data
+        /// \returns the compressed RLE data.
+        ///
+        ///////////////////////////////////////////////////////////
+        static QByteArray compress(const QByteArray &raw);
+    };
+}
+
+
+#endif  // __QBOY_RLE_HPP__
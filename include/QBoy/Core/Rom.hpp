@@ -29,6 +29,7 @@
 //
 ///////////////////////////////////////////////////////////
 #include <QBoy/Core/RomInfo.hpp>
+#include <QBoy/Core/RomCache.hpp>
 #include <QByteArray>
 #include <QList>
 
@@ -174,6 +175,13 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         UInt8 *data() const;
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of the rom in bytes.
+        /// \returns the amount of bytes within the rom.
+        ///
+        ///////////////////////////////////////////////////////////
+        UInt32 size() const;
+
         ///////////////////////////////////////////////////////////
         /// \brief Retrieves various information about this rom.
         ///
@@ -187,6 +195,18 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         const RomInfo &info() const;
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the cache of decoded assets.
+        ///
+        /// Decoders store their results in this cache, so that
+        /// reading the same asset again becomes a lookup. All
+        /// write functions drop the entries they overwrite.
+        ///
+        /// \returns a reference to the current qboy::RomCache.
+        ///
+        ///////////////////////////////////////////////////////////
+        RomCache &cache() const;
+
 
         ///////////////////////////////////////////////////////////
         /// \brief Determines whether the current offset is valid.
@@ -502,6 +522,7 @@ namespace qboy
         mutable UInt32          m_Offset;
         mutable QList<UInt32>   m_Redirected;
         QString                 m_Error;
+        mutable RomCache        m_Cache;
     };
 }
 
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_ROMCACHE_HPP__
+#define __QBOY_ROMCACHE_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+#include <QByteArray>
+#include <QCache>
+#include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Holds one decoded asset within the rom cache.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct RomCacheEntry
+    {
+        Int32 size;         // size of the encoded data
+        UInt32 hash;        // hash of the encoded data
+        QByteArray data;    // decoded data
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   RomCache.hpp
+    /// \brief  Caches decoded data by rom offset.
+    ///
+    /// Thread-safe least-recently-used cache which keeps the
+    /// decoded data of compressed assets, so that reading the
+    /// same asset twice does not decode it again. The cache is
+    /// limited by the total amount of decoded bytes. Entries
+    /// are keyed by the offset and the hash of the encoded
+    /// data; qboy::Rom drops them once a write touches them.
+    /// qboy::Image::readCompressed fills the cache by default;
+    /// images bigger than the budget bypass it.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API RomCache {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty cache with the default budget.
+        ///
+        ///////////////////////////////////////////////////////////
+        RomCache();
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Copy constructor
+        ///
+        /// Copying of qboy::RomCache objects is disabled.
+        ///
+        ///////////////////////////////////////////////////////////
+        RomCache(const RomCache &cache) = delete;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Looks up the decoded data at the given offset.
+        ///
+        /// Only returns the data if the encoded bytes within the
+        /// rom still hash to the value they had when inserted.
+        ///
+        /// \param rom Pointer to the rom data
+        /// \param length Length of the rom data
+        /// \param offset Offset of the encoded data
+        /// \param size Outputs the size of the encoded data
+        /// \returns the decoded data; null if not cached.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray find(const UInt8 *rom, UInt32 length, UInt32 offset, Int32 *size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Inserts decoded data into the cache.
+        ///
+        /// Evicts the least recently used entries if the budget
+        /// would be exceeded. Does nothing if the data alone is
+        /// bigger than the budget.
+        ///
+        /// \param rom Pointer to the rom data
+        /// \param offset Offset of the encoded data
+        /// \param size Size of the encoded data
+        /// \param data Decoded data to keep
+        ///
+        ///////////////////////////////////////////////////////////
+        void insert(const UInt8 *rom, UInt32 offset, Int32 size, const QByteArray &data);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Drops all entries overlapping the given range.
+        ///
+        /// Returns immediately if no entry can overlap the range,
+        /// without acquiring the lock.
+        ///
+        /// \param offset Start of the modified range
+        /// \param count Amount of modified bytes
+        ///
+        ///////////////////////////////////////////////////////////
+        void invalidate(UInt32 offset, Int32 count);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Drops all entries.
+        ///
+        ///////////////////////////////////////////////////////////
+        void clear();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the maximum amount of decoded bytes.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 budget() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of decoded bytes cached.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 usage() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the maximum amount of decoded bytes.
+        ///
+        /// A budget of zero disables the cache. Entries exceeding
+        /// a lowered budget are evicted immediately.
+        ///
+        /// \param bytes Maximum amount of decoded bytes
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBudget(Int32 bytes);
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        mutable QMutex                      m_Mutex;
+        QCache<UInt32, RomCacheEntry>       m_Entries;
+        QMap<UInt32, Int32>                 m_Ranges;
+        Int32                               m_Longest;
+        QAtomicInt                          m_Lower;
+        QAtomicInt                          m_Upper;
+    };
+}
+
+
+#endif  // __QBOY_ROMCACHE_HPP__
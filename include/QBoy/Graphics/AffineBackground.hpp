@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_AFFINEBACKGROUND_HPP__
+#define __QBOY_AFFINEBACKGROUND_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   AffineBackground.hpp
+    /// \brief  Renders rotated and scaled backgrounds.
+    ///
+    /// Affine maps hold one byte per entry, the number of an
+    /// 8bpp tile, and are 16, 32, 64 or 128 tiles wide and high.
+    /// The transform is given like the BGxPA-PD and BGxX/Y
+    /// registers: 8.8 and 20.8 fixed-point numbers.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API AffineBackground {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty map with the identity transform.
+        ///
+        ///////////////////////////////////////////////////////////
+        AffineBackground();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads an uncompressed affine map from the rom.
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the map within the rom
+        /// \param size Width and height of the map in tiles
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readUncompressed(const Rom &rom, UInt32 offset, Int32 size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads a compressed affine map from the rom.
+        ///
+        /// The size of the map follows from the entry count.
+        ///
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the map within the rom
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readCompressed(const Rom &rom, UInt32 offset);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the entries, row by row.
+        /// \param entries One tile number per entry
+        /// \returns false if the map is not 16, 32, 64 or 128
+        ///          tiles in size.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setEntries(const QByteArray &entries);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the 8bpp tiles of the map.
+        ///
+        /// Tile numbers count through the tiles of the image row
+        /// by row. Numbers beyond the image are transparent.
+        ///
+        /// \param tiles Image holding the tiles
+        ///
+        ///////////////////////////////////////////////////////////
+        void setTiles(const Image &tiles);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the transform of the background.
+        /// \param pa Horizontal step of x per pixel (8.8)
+        /// \param pb Horizontal step of x per scanline (8.8)
+        /// \param pc Vertical step of y per pixel (8.8)
+        /// \param pd Vertical step of y per scanline (8.8)
+        /// \param x Map position of the upper-left pixel (20.8)
+        /// \param y Map position of the upper-left pixel (20.8)
+        ///
+        ///////////////////////////////////////////////////////////
+        void setTransform(Int16 pa, Int16 pb, Int16 pc, Int16 pd, Int32 x, Int32 y);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the behaviour outside of the map.
+        /// \param wrap Should the map repeat or be transparent?
+        ///
+        ///////////////////////////////////////////////////////////
+        void setWrap(Boolean wrap);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of the map in tiles.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 size() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Renders the background to palette indices.
+        /// \param width Width of the output in pixels
+        /// \param height Height of the output in pixels
+        /// \returns one index per pixel; zero is transparent.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray renderIndexed(Int32 width = 240, Int32 height = 160) const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Renders the background to RGBA colors.
+        /// \param palette Palette of 256 colors
+        /// \param width Width of the output in pixels
+        /// \param height Height of the output in pixels
+        /// \returns one color per pixel; index zero is transparent.
+        ///
+        ///////////////////////////////////////////////////////////
+        QVector<Color> render(const Palette &palette, Int32 width = 240, Int32 height = 160) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Composes the entries and tiles to one bitmap.
+        ///
+        ///////////////////////////////////////////////////////////
+        void compose();
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QByteArray      m_Entries;
+        QByteArray      m_Tiles;
+        QByteArray      m_Bitmap;
+        Int32           m_Size;
+        Int32           m_TileCount;
+        Int16           m_Pa;
+        Int16           m_Pb;
+        Int16           m_Pc;
+        Int16           m_Pd;
+        Int32           m_X;
+        Int32           m_Y;
+        Boolean         m_Wrap;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_AFFINEBACKGROUND_HPP__
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_COLORCODEC_HPP__
+#define __QBOY_COLORCODEC_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+#include <QBoy/Graphics/Color.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   ColorCodec.hpp
+    /// \brief  Converts between GBA and RGBA colors.
+    ///
+    /// GBA colors hold five bits per channel: red in the lowest
+    /// bits, then green and blue. Expanding a channel repeats
+    /// its upper bits, so that 31 becomes 255. Converts eight
+    /// colors at once with SSE2 where available.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API ColorCodec {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts 15-bit GBA colors to RGBA colors.
+        /// \param input Pointer to the GBA colors
+        /// \param count Amount of colors to convert
+        /// \param output Pointer to the RGBA output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decode(const UInt16 *input, Int32 count, Color *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts little-endian GBA color data to RGBA.
+        /// \param input Pointer to the data, two bytes per color
+        /// \param count Amount of colors to convert
+        /// \param output Pointer to the RGBA output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decodeBytes(const UInt8 *input, Int32 count, Color *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts RGBA colors to 15-bit GBA colors.
+        ///
+        /// Drops the lower three bits of each channel and alpha.
+        ///
+        /// \param input Pointer to the RGBA colors
+        /// \param count Amount of colors to convert
+        /// \param output Pointer to the GBA output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void encode(const Color *input, Int32 count, UInt16 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts RGBA colors to little-endian GBA data.
+        /// \param input Pointer to the RGBA colors
+        /// \param count Amount of colors to convert
+        /// \param output Pointer to the output, two bytes per color
+        ///
+        ///////////////////////////////////////////////////////////
+        static void encodeBytes(const Color *input, Int32 count, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts RGBA colors to OpenGL colors.
+        /// \param input Pointer to the RGBA colors
+        /// \param count Amount of colors to convert
+        /// \param output Pointer to the floating-point output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void toGL(const Color *input, Int32 count, GLColor *output);
+    };
+}
+
+
+#endif  // __QBOY_COLORCODEC_HPP__
@@ -28,6 +28,7 @@
 // Include files
 //
 ///////////////////////////////////////////////////////////
+#include <QBoy/Core/Lz77.hpp>
 #include <QBoy/Graphics/Palette.hpp>
 #include <QBoy/OpenGL/IndexedTexture.hpp>
 
@@ -47,6 +48,47 @@ namespace qboy
     class QBOY_API Image {
     public:
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Iterates over the pixel indices row by row.
+        ///
+        /// Works on both plain and packed images.
+        ///
+        ///////////////////////////////////////////////////////////
+        class PixelIterator {
+        public:
+
+            PixelIterator(const UInt8 *data, Int32 index, Boolean packed)
+                : m_Data(data), m_Index(index), m_IsPacked(packed)
+            {
+            }
+
+            UInt8 operator*() const
+            {
+                if (m_IsPacked)
+                    return (m_Data[m_Index >> 1] >> ((m_Index & 1) * 4)) & 0x0F;
+                else
+                    return m_Data[m_Index];
+            }
+
+            PixelIterator &operator++()
+            {
+                m_Index++;
+                return *this;
+            }
+
+            bool operator==(const PixelIterator &other) const { return m_Index == other.m_Index; }
+            bool operator!=(const PixelIterator &other) const { return m_Index != other.m_Index; }
+
+            Int32 index() const { return m_Index; }
+
+        private:
+
+            const UInt8    *m_Data;
+            Int32           m_Index;
+            Boolean         m_IsPacked;
+        };
+
+
         ///////////////////////////////////////////////////////////
         /// \brief Default constructor
         ///
@@ -90,9 +132,16 @@ namespace qboy
 
         ///////////////////////////////////////////////////////////
         /// \brief Reads a compressed image from the rom.
+        ///
+        /// Keeps the decoded data in the rom cache by default, so
+        /// that reading the image again is a lookup. Data that
+        /// exceeds the cache budget, or any data if caching is
+        /// not requested, is decoded through a small ring buffer.
+        ///
         /// \param rom Currently active rom instance
         /// \param offset Offset of the image within the rom
         /// \param width Width of the resulting image
+        /// \param cache Keep the decoded data in the rom cache?
         /// \returns the success of the procedure.
         ///
         ///////////////////////////////////////////////////////////
@@ -100,7 +149,8 @@ namespace qboy
                 const Rom &rom,
                 UInt32 offset,
                 Int32 width,
-                Boolean is4bpp
+                Boolean is4bpp,
+                Boolean cache = true
         );
 
         // TODO: write
@@ -110,12 +160,41 @@ namespace qboy
         ///
         /// Even if attempting to load a 4bpp image, will be
         /// converted to a 8bpp one for compatibility with OpenGL.
+        /// Packed images hold two pixels per byte instead; the
+        /// left one in the low nibble.
         ///
         /// \returns the raw 8bpp (index) data.
         ///
         ///////////////////////////////////////////////////////////
         const QByteArray &raw() const;
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the palette index of one pixel.
+        /// \param x X-position of the pixel
+        /// \param y Y-position of the pixel
+        /// \returns the palette index of the pixel.
+        ///
+        ///////////////////////////////////////////////////////////
+        UInt8 pixel(Int32 x, Int32 y) const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves an iterator to the first pixel.
+        ///
+        ///////////////////////////////////////////////////////////
+        PixelIterator begin() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves an iterator past the last pixel.
+        ///
+        ///////////////////////////////////////////////////////////
+        PixelIterator end() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Determines whether the pixels are stored packed.
+        ///
+        ///////////////////////////////////////////////////////////
+        Boolean isPacked() const;
+
         ///////////////////////////////////////////////////////////
         /// \brief Retrieves the associated palette.
         /// \returns the associated qboy::Palette pointer.
@@ -139,6 +218,18 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         const IndexedTexture *texture(QOpenGLFunctions *funcs, QOpenGLWidget *parent) const;
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves an 8bpp texture using a palette bank.
+        ///
+        /// Does not need a palette; the colors are looked up at
+        /// the given offset within the bank instead.
+        ///
+        /// \param bank Bank containing the palette
+        /// \param offset Offset returned by qboy::PaletteBank::add
+        ///
+        ///////////////////////////////////////////////////////////
+        const IndexedTexture *texture(QOpenGLFunctions *funcs, QOpenGLWidget *parent, PaletteBank *bank, Int32 offset) const;
+
 
         ///////////////////////////////////////////////////////////
         /// \brief Specifies the raw 8bpp pixel data.
@@ -152,6 +243,30 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         void setRaw(const QByteArray &raw);
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the palette index of one pixel.
+        /// \param x X-position of the pixel
+        /// \param y Y-position of the pixel
+        /// \param index New palette index of the pixel
+        ///
+        ///////////////////////////////////////////////////////////
+        void setPixel(Int32 x, Int32 y, UInt8 index);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies whether to store 4bpp pixels packed.
+        ///
+        /// Packed images keep two pixels per byte, which halves
+        /// the memory and the texture upload. The shader unpacks
+        /// them on the GPU. Converts the current pixels, if any;
+        /// otherwise, applies to the next image that is read.
+        /// Reading an 8bpp image turns this mode off.
+        ///
+        /// \param packed True to store two pixels per byte
+        /// \returns false if the current image is not 4bpp.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setPacked(Boolean packed);
+
         ///////////////////////////////////////////////////////////
         /// \brief Specifies the size of the image.
         ///
@@ -181,10 +296,16 @@ namespace qboy
 
         ///////////////////////////////////////////////////////////
         /// \brief Writes the image to ROM.
+        ///
+        /// LZ77 data is compressed directly into the rom. If the
+        /// offset is the one the image was read from, it may
+        /// overwrite the previous data; it may grow into free
+        /// space. The rom stays untouched if it does not fit.
+        ///
         /// \param rom Currently opened ROM file
         /// \param offset Offset to write image to
         /// \param isLz77 Should image be LZ77-compressed?
-        /// \returns false if image could not be compressed.
+        /// \returns false if the image could not be written.
         ///
         ///////////////////////////////////////////////////////////
         bool write(Rom &rom, UInt32 offset, Boolean isLz77);
@@ -193,12 +314,41 @@ namespace qboy
 
     protected:
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Sizes the raw data for the given tile data.
+        /// \param length Length of the tile data in bytes
+        /// \param width Width of the image; a multiple of 8
+        /// \param is4bpp Is the data 4bpp or 8bpp?
+        ///
+        ///////////////////////////////////////////////////////////
+        void allocate(Int32 length, Int32 width, Boolean is4bpp);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts GBA tile data to the raw data.
+        /// \param data 4bpp or 8bpp tile data
+        /// \param width Width of the image; a multiple of 8
+        /// \param is4bpp Is the data 4bpp or 8bpp?
+        ///
+        ///////////////////////////////////////////////////////////
+        void convertFromGBA(const QByteArray &data, Int32 width, Boolean is4bpp);
+
         ///////////////////////////////////////////////////////////
         /// \brief Converts the raw data to GBA index data.
         ///
         ///////////////////////////////////////////////////////////
         void convertToGBA();
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the LZ77-compressed GBA index data.
+        ///
+        /// Compresses the current GBA index data, unless it did
+        /// not change since the last compression. In that case,
+        /// the cached result is returned right away. After small
+        /// edits, only the modified part is compressed again.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QByteArray &compressed();
+
 
     private:
 
@@ -209,10 +359,15 @@ namespace qboy
         QByteArray          m_Data;
         Palette            *m_Palette;
         Int32               m_DataSize;
+        UInt32              m_Offset;
         Int32               m_Width;
         Int32               m_Height;
         Boolean             m_Is4Bpp;
+        Boolean             m_IsPacked;
         QByteArray          m_Buffer;
+        QByteArray          m_Encoded;
+        QByteArray          m_EncodedKey;
+        QVector<Lz77Checkpoint> m_Checkpoints;
         QString             m_LastError;
     };
 }
@@ -37,6 +37,9 @@ namespace qboy
     #define IMG_ERROR_OFFSET    "Given image offset is out of rom range."
     #define IMG_ERROR_LZ77      "The LZ77 data of the image is broken."
     #define IMG_ERROR_LENGTH    "The length is not a multiple of 2 or the width is not a multiple of 8."
+    #define IMG_ERROR_SPACE     "Not enough free space to write the image to."
+    #define IMG_ERROR_TILES     "The image consists of more than 1024 unique tiles."
+    #define IMG_ERROR_FRAMES    "The data does not hold a single frame of the given sprite size."
 }
 
 
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_IMAGEIMPORTER_HPP__
+#define __QBOY_IMAGEIMPORTER_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QIODevice>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   ImageImporter.hpp
+    /// \brief  Reads indexed PNG and BMP files.
+    ///
+    /// Converts the pixels row by row right to palette indices;
+    /// no 32-bit image is ever created. Supports 1, 2, 4 and 8
+    /// bits per pixel (BMP: 1, 4 and 8, uncompressed only).
+    /// Palettes are padded to 16 or 256 colors.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API ImageImporter {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty image and palette.
+        ///
+        ///////////////////////////////////////////////////////////
+        ImageImporter();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads the image file at the given path.
+        /// \param path Path of the PNG or BMP file
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool read(const QString &path);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads an image file from the given device.
+        ///
+        /// The format is determined by the file signature.
+        ///
+        /// \param device Device opened for reading
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool read(QIODevice *device);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the imported palette indices.
+        ///
+        ///////////////////////////////////////////////////////////
+        const Image &image() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the imported palette.
+        ///
+        ///////////////////////////////////////////////////////////
+        const Palette &palette() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts the imported image to GBA tile data.
+        /// \param is4bpp Should the tiles be 4bpp or 8bpp?
+        /// \returns tile data, ready to be written to the rom.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray toGBA(Boolean is4bpp) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads the chunks of a PNG file.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readPng(QIODevice *device);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads the headers and rows of a BMP file.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readBmp(QIODevice *device, const QByteArray &signature);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Validates the size and allocates the indices.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool allocate(Int32 width, Int32 height);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Pads the given colors and sets the palette.
+        ///
+        ///////////////////////////////////////////////////////////
+        void setColors(QVector<Color> colors, Int32 depth);
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        Image           m_Image;
+        Palette         m_Palette;
+        QByteArray      m_Indices;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_IMAGEIMPORTER_HPP__
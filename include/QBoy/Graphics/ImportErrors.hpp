@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_IMPORTERRORS_HPP__
+#define __QBOY_IMPORTERRORS_HPP__
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   ImportErrors.hpp
+    /// \brief  Defines several error strings for image import.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    #define IMP_ERROR_FILE      "The image file could not be opened for reading."
+    #define IMP_ERROR_FORMAT    "The file is neither an indexed PNG nor an uncompressed indexed BMP."
+    #define IMP_ERROR_DATA      "The pixel data of the image file is broken."
+    #define IMP_ERROR_ALIGN     "The width and height of the image are not multiples of 8."
+    #define IMP_ERROR_SIZE      "The image is empty or exceeds 4096x4096 pixels."
+}
+
+
+#endif  // __QBOY_IMPORTERRORS_HPP__
@@ -30,11 +30,15 @@
 ///////////////////////////////////////////////////////////
 #include <QBoy/Core/Rom.hpp>
 #include <QBoy/Graphics/Color.hpp>
+#include <QSharedDataPointer>
 #include <QVector>
 
 
 namespace qboy
 {
+    class PaletteData;
+
+
     ///////////////////////////////////////////////////////////
     /// \author Pokedude
     /// \date   07/05/2016
@@ -44,6 +48,10 @@ namespace qboy
     /// Reads LZ77 compressed and uncompressed palettes within
     /// the rom which consist of either 16 or 256 colors.
     ///
+    /// Only the native GBA colors are stored; RGBA and OpenGL
+    /// colors are derived on first access. Copies share their
+    /// data until either of them is modified.
+    ///
     ///////////////////////////////////////////////////////////
     class QBOY_API Palette {
     public:
@@ -64,6 +72,20 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         Palette(const Palette &pal);
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        ///////////////////////////////////////////////////////////
+        ~Palette();
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Assignment operator
+        ///
+        /// Shares the colors of another qboy::Palette.
+        ///
+        ///////////////////////////////////////////////////////////
+        Palette &operator=(const Palette &pal);
+
 
         ///////////////////////////////////////////////////////////
         /// \brief Reads an uncompressed 16/256-color palette.
@@ -103,6 +125,23 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         const QVector<GLColor> &rawGL() const;
 
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the native GBA color data.
+        ///
+        /// Holds two little-endian bytes per color, exactly as
+        /// they are stored within the rom.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QByteArray &rawGBA() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of the palette data in the rom.
+        ///
+        /// For LZ77 palettes, this is the compressed size.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 dataSize() const;
+
         ///////////////////////////////////////////////////////////
         /// \brief Retrieves the last error upon loading or writing.
         /// \returns the last error (no stacking!).
@@ -116,6 +155,7 @@ namespace qboy
         ///
         /// The given vector must either contain 16 or 256 colors.
         /// An error will be thrown if this condition is not met.
+        /// Colors are reduced to the GBA's five bits per channel.
         ///
         /// \param raw Raw color vector, sized 16 or 256
         ///
@@ -133,6 +173,12 @@ namespace qboy
 
         ///////////////////////////////////////////////////////////
         /// \brief Writes the palette to the given offset.
+        ///
+        /// LZ77 data is compressed directly into the rom. If the
+        /// offset is the one the palette was read from, it may
+        /// overwrite the previous data; it may grow into free
+        /// space. The rom stays untouched if it does not fit.
+        ///
         /// \param rom Currently opened ROM file
         /// \param offset Offset to write palette to
         /// \param lz77 Should palette be LZ77-encoded?
@@ -145,18 +191,28 @@ namespace qboy
     protected:
 
         ///////////////////////////////////////////////////////////
-        /// \brief Converts raw GBA color data to RGBA data.
+        /// \brief Takes over raw GBA color data.
         /// \param array List of hwords containing the GBA entries
         ///
         ///////////////////////////////////////////////////////////
         bool convertGBA(const QList<UInt16> &entries);
 
         ///////////////////////////////////////////////////////////
-        /// \brief Converts the raw RGBA data to GBA color data.
-        /// \returns the encoded byte array of the data.
+        /// \brief Takes over little-endian GBA color data.
+        /// \param data Two bytes per color, as stored in the rom
+        ///
+        ///////////////////////////////////////////////////////////
+        bool convertGBA(const QByteArray &data);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the LZ77-compressed GBA color data.
+        ///
+        /// Compresses the current GBA color data, unless it did
+        /// not change since the last compression. In that case,
+        /// the cached result is returned right away.
         ///
         ///////////////////////////////////////////////////////////
-        void convertRaw();
+        const QByteArray &compressed() const;
 
 
     private:
@@ -165,14 +221,13 @@ namespace qboy
         // Class members
         //
         ///////////////////////////////////////////////////////////
-        QVector<Color>      m_Data;
-        QVector<GLColor>    m_DataGL;
+        QSharedDataPointer<PaletteData> m_Data;
         Int32               m_DataSize;
         Int32               m_ColorCount;
+        UInt32              m_Offset;
         QString             m_LastError;
-        QByteArray          m_Buffer;
    };
 }
 
 
-#endif  // __QBOY_PsALETTE_HPP__
+#endif  // __QBOY_PALETTE_HPP__
@@ -37,6 +37,8 @@ namespace qboy
     #define PAL_ERROR_COUNT         "Palette count must be 16 or 256!"
     #define PAL_ERROR_OFFSET        "Given palette offset is out of rom range."
     #define PAL_ERROR_LZ77          "LZ77-data of the palette is invalid."
+    #define PAL_ERROR_SPACE         "Not enough free space to write the palette to."
+    #define PAL_ERROR_BANK          "The palette bank has no room for further palettes."
 }
 
 
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_PALETTEPOOL_HPP__
+#define __QBOY_PALETTEPOOL_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Palette.hpp>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Holds one location read into the palette pool.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct PalettePoolEntry
+    {
+        Int32 size;                             // size of the data in the rom
+        UInt32 hash;                            // hash of the data in the rom
+        QSharedPointer<const Palette> palette;  // palette read from there
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Describes where a palette was read from.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct PaletteLocation
+    {
+        UInt32  offset;
+        Boolean isCompressed;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   PalettePool.hpp
+    /// \brief  Shares palettes with identical colors.
+    ///
+    /// Palettes are keyed by their GBA color data, so that all
+    /// identical palettes within the rom resolve to the same
+    /// immutable instance. Remembers every location a palette
+    /// was read from; reading a location again only checks
+    /// that its bytes in the rom did not change since.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API PalettePool {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty pool.
+        ///
+        ///////////////////////////////////////////////////////////
+        PalettePool();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads an uncompressed palette into the pool.
+        /// \param rom Currently active rom file
+        /// \param offset Offset of the palette in the rom
+        /// \param count Amount of colors to read. Must be 16/256!
+        /// \returns the shared palette or null on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSharedPointer<const Palette> readUncompressed(const Rom &rom, UInt32 offset, Int32 count);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads a compressed palette into the pool.
+        /// \param rom Currently active rom file
+        /// \param offset Offset of the palette in the rom
+        /// \returns the shared palette or null on failure.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSharedPointer<const Palette> readCompressed(const Rom &rom, UInt32 offset);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the shared instance of a palette.
+        ///
+        /// Adds the palette to the pool if no palette with the
+        /// same colors exists yet. Does not record a location.
+        ///
+        /// \param palette Palette to look up
+        ///
+        ///////////////////////////////////////////////////////////
+        QSharedPointer<const Palette> intern(const Palette &palette);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves all locations sharing their colors.
+        ///
+        /// Each group lists at least two locations, sorted by
+        /// offset. Tools may write one copy of the palette and
+        /// repoint all other locations of the group to it.
+        /// Locations whose bytes were changed in the given rom
+        /// are dropped from the pool first.
+        ///
+        /// \param rom Rom the locations refer to
+        ///
+        ///////////////////////////////////////////////////////////
+        QList<QList<PaletteLocation>> duplicates(const Rom &rom);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of distinct palettes.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 count() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of locations read.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 locations() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the last error upon reading.
+        /// \returns the last error (no stacking!).
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Removes all palettes and locations.
+        ///
+        /// Palettes still referenced elsewhere stay valid.
+        ///
+        ///////////////////////////////////////////////////////////
+        void clear();
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QHash<QByteArray, QSharedPointer<const Palette>>    m_Palettes;
+        QHash<UInt64, PalettePoolEntry>                     m_Locations;
+        QString                                             m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_PALETTEPOOL_HPP__
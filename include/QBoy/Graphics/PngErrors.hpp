@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_PNGERRORS_HPP__
+#define __QBOY_PNGERRORS_HPP__
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   PngErrors.hpp
+    /// \brief  Defines several error strings for PNG files.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    #define PNG_ERROR_EMPTY     "The image lacks pixels or the palette has no colors."
+    #define PNG_ERROR_FILE      "The PNG file could not be opened for writing."
+    #define PNG_ERROR_WRITE     "The PNG data could not be written completely."
+    #define PNG_ERROR_COLORS    "The palette holds more than 256 colors."
+    #define PNG_ERROR_INDEX     "A pixel refers to a color beyond the palette."
+}
+
+
+#endif  // __QBOY_PNGERRORS_HPP__
@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_PNGWRITER_HPP__
+#define __QBOY_PNGWRITER_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QIODevice>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Describes one file of a batch export.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct PngEntry
+    {
+        const Image *image;
+        const Palette *palette;
+        QString path;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   PngWriter.hpp
+    /// \brief  Writes images as indexed PNG files.
+    ///
+    /// Keeps the palette as it is (PLTE) instead of converting
+    /// the image to 32-bit colors. Palettes of 16 colors yield
+    /// 4-bit pixels. Color zero can be marked as transparent.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API PngWriter {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Uses the default compression and a transparent color
+        /// zero.
+        ///
+        ///////////////////////////////////////////////////////////
+        PngWriter();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the deflate compression level.
+        ///
+        /// Level 1 is the fastest, level 9 yields the smallest
+        /// files and -1 chooses the default of zlib (6).
+        ///
+        /// \param level Compression level, -1 to 9
+        ///
+        ///////////////////////////////////////////////////////////
+        void setLevel(Int32 level);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies whether color zero is transparent.
+        /// \param transparent Should a tRNS chunk be written?
+        ///
+        ///////////////////////////////////////////////////////////
+        void setTransparent(Boolean transparent);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Encodes the image to PNG data.
+        ///
+        /// Fails if the palette holds more than 256 colors or a
+        /// pixel refers to a color beyond the palette.
+        ///
+        /// \param image Image to encode
+        /// \param palette Palette of up to 256 colors
+        /// \returns the PNG file data or a null array.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray encode(const Image &image, const Palette &palette) const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Writes the image to the given device.
+        /// \param device Device opened for writing
+        /// \param image Image to write
+        /// \param palette Palette of 16 or 256 colors
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool write(QIODevice *device, const Image &image, const Palette &palette);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Writes the image to the given file.
+        /// \param path Path of the file
+        /// \param image Image to write
+        /// \param palette Palette of 16 or 256 colors
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool write(const QString &path, const Image &image, const Palette &palette);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Writes many images on multiple cores.
+        ///
+        /// Attempts to write every file, even if some of them
+        /// fail. The last error names the first failed file.
+        ///
+        /// \param entries Images, palettes and file paths
+        /// \returns the amount of files written successfully.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 writeBatch(const QVector<PngEntry> &entries);
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Encodes the image to PNG data.
+        ///
+        /// Checks the image only once and reports why it can not
+        /// be stored with the palette, if so.
+        ///
+        /// \param image Image to encode
+        /// \param palette Palette of up to 256 colors
+        /// \param error Outputs the error string on failure
+        /// \returns the PNG file data or a null array.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray encode(const Image &image, const Palette &palette, const char **error) const;
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        Int32           m_Level;
+        Boolean         m_Transparent;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_PNGWRITER_HPP__
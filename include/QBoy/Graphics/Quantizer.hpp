@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_QUANTIZER_HPP__
+#define __QBOY_QUANTIZER_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QList>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Quantizer.hpp
+    /// \brief  Reduces true-color images to GBA palettes.
+    ///
+    /// Works on 15-bit colors from the start, since the GBA
+    /// can not display more. The palette is built by median
+    /// cut and refined by k-means. Color zero is reserved for
+    /// transparency; pixels with alpha below 128 map to it.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Quantizer {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes the quantizer with eight iterations.
+        ///
+        ///////////////////////////////////////////////////////////
+        Quantizer();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the amount of k-means iterations.
+        /// \param iterations Iterations; zero is median cut only
+        ///
+        ///////////////////////////////////////////////////////////
+        void setIterations(Int32 iterations);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reduces the image to one palette.
+        /// \param pixels True-color pixels, row by row
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param colors Size of the palette, 16 or 256
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool quantize(const QVector<Color> &pixels, Int32 width, Int32 height, Int32 colors);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reduces the image to 16-color sub-palettes.
+        ///
+        /// Tiles with similar colors share a sub-palette. The
+        /// image holds 4bpp indices afterwards and banks() tells
+        /// the sub-palette of each tile.
+        ///
+        /// \param pixels True-color pixels, row by row
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param palettes Amount of sub-palettes, 1 to 16
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool quantizeTiles(const QVector<Color> &pixels, Int32 width, Int32 height, Int32 palettes);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the resulting palette indices.
+        ///
+        ///////////////////////////////////////////////////////////
+        const Image &image() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the resulting palettes.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QList<Palette> &palettes() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the sub-palette of each tile.
+        ///
+        /// Holds one bank per tile, row by row, to be merged into
+        /// the tilemap entries (see qboy::TE_PaletteMask). Zero
+        /// for all tiles after quantize().
+        ///
+        ///////////////////////////////////////////////////////////
+        const QVector<UInt8> &banks() const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Validates the size and converts the pixels.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool prepare(const QVector<Color> &pixels, Int32 width, Int32 height);
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QVector<Int32>  m_Colors;
+        Image           m_Image;
+        QList<Palette>  m_Palettes;
+        QVector<UInt8>  m_Banks;
+        Int32           m_Iterations;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_QUANTIZER_HPP__
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_REMAPPER_HPP__
+#define __QBOY_REMAPPER_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the dithering methods for remapping.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum DitherMode : int
+    {
+        DM_None             = 0,
+        DM_Ordered          = 1,
+        DM_FloydSteinberg   = 2
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Remapper.hpp
+    /// \brief  Maps true-color pixels to an existing palette.
+    ///
+    /// Finds the nearest palette color of all 32768 GBA colors
+    /// once per palette, so mapping a pixel is a table lookup.
+    /// Pixels with alpha below 128 map to color zero.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Remapper {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes a remapper without palette.
+        ///
+        ///////////////////////////////////////////////////////////
+        Remapper();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the palette to map to.
+        ///
+        /// Builds the lookup table on all cores. The strength of
+        /// ordered dithering follows the spacing of the colors.
+        ///
+        /// \param palette Palette to map to
+        /// \param reserveZero Should color zero be left out?
+        /// \returns false if there are no colors to map to.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setPalette(const Palette &palette, Boolean reserveZero = true);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the nearest palette index of a color.
+        /// \param color Color to look up
+        ///
+        ///////////////////////////////////////////////////////////
+        UInt8 nearest(const Color &color) const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Maps the given pixels to the palette.
+        /// \param pixels True-color pixels, row by row
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param mode Dithering method to apply
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool remap(const QVector<Color> &pixels, Int32 width, Int32 height, DitherMode mode = DM_None);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the resulting palette indices.
+        ///
+        ///////////////////////////////////////////////////////////
+        const Image &image() const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QVector<UInt8>  m_Lookup;
+        QVector<Color>  m_Colors;
+        Image           m_Image;
+        Int32           m_Spread;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_REMAPPER_HPP__
@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_REMAPPERERRORS_HPP__
+#define __QBOY_REMAPPERERRORS_HPP__
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   RemapperErrors.hpp
+    /// \brief  Defines several error strings for remapping.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    #define RMP_ERROR_PALETTE   "The palette has no colors to map to."
+    #define RMP_ERROR_SIZE      "The size is not a multiple of 8 or does not match the pixel count."
+}
+
+
+#endif  // __QBOY_REMAPPERERRORS_HPP__
@@ -0,0 +1,305 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_SOFTWARERENDERER_HPP__
+#define __QBOY_SOFTWARERENDERER_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QBoy/Graphics/Tilemap.hpp>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the color special effects.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum BlendMode : int
+    {
+        BM_None         = 0,
+        BM_Alpha        = 1,
+        BM_Brighten     = 2,
+        BM_Darken       = 3
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the layers as blend target bits.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum RenderLayer : int
+    {
+        RL_Bg0          = 0x01,
+        RL_Bg1          = 0x02,
+        RL_Bg2          = 0x04,
+        RL_Bg3          = 0x08,
+        RL_Obj          = 0x10,
+        RL_Backdrop     = 0x20
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Describes one sprite to render.
+    ///
+    /// The image holds the whole sprite, row by row. For 4bpp
+    /// sprites, bank selects one of the sprite palettes.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct RenderSprite
+    {
+        const Image *image;
+        Int32 x;
+        Int32 y;
+        Int32 priority;
+        Int32 bank;
+        Boolean is4bpp;
+        Boolean hflip;
+        Boolean vflip;
+        Boolean semiTransparent;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   SoftwareRenderer.hpp
+    /// \brief  Renders backgrounds and sprites on the CPU.
+    ///
+    /// Counterpart to the OpenGL path for systems without GPU.
+    /// Stacks four text backgrounds and the sprites by their
+    /// priorities and applies the color special effects with
+    /// 15-bit colors, just like the GBA does. The scanlines of
+    /// a frame are rendered on multiple cores.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API SoftwareRenderer {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes a renderer with disabled layers.
+        ///
+        /// \param width Width of the frame in pixels
+        /// \param height Height of the frame in pixels
+        ///
+        ///////////////////////////////////////////////////////////
+        SoftwareRenderer(Int32 width = 240, Int32 height = 160);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the background palettes.
+        ///
+        /// Holds 16 palettes of 16 colors or one of 256 colors.
+        /// Each palette starts at the next free bank and takes
+        /// as many banks as its colors need; null entries skip
+        /// one bank. The very first color is the backdrop.
+        ///
+        /// \param palettes Palettes, in order of their banks
+        /// \returns false if the palettes need over 256 colors.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setBackgroundPalettes(const QList<const Palette *> &palettes);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the sprite palettes.
+        ///
+        /// Follows the rules of setBackgroundPalettes.
+        ///
+        /// \param palettes Palettes, in order of their banks
+        /// \returns false if the palettes need over 256 colors.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setSpritePalettes(const QList<const Palette *> &palettes);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the content of a background.
+        ///
+        /// Composes the tilemap once, so that rendering frames
+        /// only reads the resulting indices. Enables the layer.
+        ///
+        /// \param layer Number of the background, 0 to 3
+        /// \param map Tilemap of the background
+        /// \param tiles Image holding the tiles
+        /// \param is4bpp Are the tiles 4bpp or 8bpp?
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBackground(Int32 layer, const Tilemap &map, const Image &tiles, Boolean is4bpp);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Enables or disables a background.
+        /// \param layer Number of the background, 0 to 3
+        /// \param enabled Should the background be rendered?
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBackgroundEnabled(Int32 layer, Boolean enabled);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the priority of a background.
+        /// \param layer Number of the background, 0 to 3
+        /// \param priority Priority from 0 (top) to 3 (bottom)
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBackgroundPriority(Int32 layer, Int32 priority);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the scroll offset of a background.
+        /// \param layer Number of the background, 0 to 3
+        /// \param x Horizontal offset in pixels
+        /// \param y Vertical offset in pixels
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBackgroundScroll(Int32 layer, Int32 x, Int32 y);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the sprites to render.
+        ///
+        /// Copies the pixels of all sprites. Of two overlapping
+        /// sprites with equal priority, the former one is drawn.
+        ///
+        /// \param sprites Sprites in OAM order
+        ///
+        ///////////////////////////////////////////////////////////
+        void setSprites(const QVector<RenderSprite> &sprites);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the color special effect.
+        /// \param mode Effect to apply to the first target
+        /// \param first Layers of the first target (RenderLayer)
+        /// \param second Layers of the second target (RenderLayer)
+        /// \param eva Weight of the first target, 0 to 16
+        /// \param evb Weight of the second target, 0 to 16
+        /// \param evy Brightness coefficient, 0 to 16
+        ///
+        ///////////////////////////////////////////////////////////
+        void setBlending(
+                BlendMode mode,
+                Int32 first,
+                Int32 second,
+                Int32 eva = 16,
+                Int32 evb = 0,
+                Int32 evy = 0
+        );
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of a frame in pixels.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSize size() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Renders one frame.
+        /// \returns one color per pixel, row by row.
+        ///
+        ///////////////////////////////////////////////////////////
+        QVector<Color> render() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Renders one frame into the given buffer.
+        /// \param output Buffer with one color per pixel
+        ///
+        ///////////////////////////////////////////////////////////
+        void render(Color *output) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Renders the given range of scanlines.
+        /// \param first First scanline to render
+        /// \param count Amount of scanlines to render
+        /// \param output Buffer with one color per pixel
+        ///
+        ///////////////////////////////////////////////////////////
+        void renderLines(Int32 first, Int32 count, Color *output) const;
+
+
+        ///////////////////////////////////////////////////////////
+        // Class structures
+        //
+        ///////////////////////////////////////////////////////////
+        struct Background
+        {
+            QByteArray indices;
+            Int32 width;
+            Int32 height;
+            Int32 scrollX;
+            Int32 scrollY;
+            Int32 priority;
+            UInt8 mask;
+            Boolean enabled;
+        };
+
+        struct Sprite
+        {
+            Int32 offset;
+            Int32 x;
+            Int32 y;
+            Int32 width;
+            Int32 height;
+            Int32 priority;
+            Boolean semiTransparent;
+        };
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        Background          m_Backgrounds[4];
+        QVector<Sprite>     m_Sprites;
+        QByteArray          m_SpritePixels;
+        QVector<UInt16>     m_BgColors;
+        QVector<UInt16>     m_ObjColors;
+        Int32               m_Width;
+        Int32               m_Height;
+        BlendMode           m_Mode;
+        Int32               m_First;
+        Int32               m_Second;
+        Int32               m_Eva;
+        Int32               m_Evb;
+        Int32               m_Evy;
+        QString             m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_SOFTWARERENDERER_HPP__
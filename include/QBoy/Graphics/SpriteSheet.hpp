@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_SPRITESHEET_HPP__
+#define __QBOY_SPRITESHEET_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+#include <QBoy/Graphics/Image.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the OAM sprite shapes.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum SpriteShape : int
+    {
+        SS_Square       = 0,
+        SS_Horizontal   = 1,
+        SS_Vertical     = 2
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   SpriteSheet.hpp
+    /// \brief  Decodes all frames of an animated sprite.
+    ///
+    /// The frames follow each other within the tile data, as
+    /// with the 1D OBJ mapping. All frames are decoded at once
+    /// into one buffer; frame n starts at n * width * height.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API SpriteSheet {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty sprite sheet.
+        ///
+        ///////////////////////////////////////////////////////////
+        SpriteSheet();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads uncompressed frames from the rom.
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the first frame within the rom
+        /// \param shape OAM shape of the frames
+        /// \param size OAM size of the frames, 0 to 3
+        /// \param frames Amount of frames to read
+        /// \param is4bpp Are the frames 4bpp or 8bpp?
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readUncompressed(
+                const Rom &rom,
+                UInt32 offset,
+                SpriteShape shape,
+                Int32 size,
+                Int32 frames,
+                Boolean is4bpp
+        );
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads compressed frames from the rom.
+        ///
+        /// The amount of frames follows from the data length.
+        ///
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the frames within the rom
+        /// \param shape OAM shape of the frames
+        /// \param size OAM size of the frames, 0 to 3
+        /// \param is4bpp Are the frames 4bpp or 8bpp?
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readCompressed(
+                const Rom &rom,
+                UInt32 offset,
+                SpriteShape shape,
+                Int32 size,
+                Boolean is4bpp
+        );
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the pixel size of one OAM shape/size.
+        /// \param shape OAM shape of the sprite
+        /// \param size OAM size of the sprite, 0 to 3
+        ///
+        ///////////////////////////////////////////////////////////
+        static QSize frameSize(SpriteShape shape, Int32 size);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the pixel size of each frame.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSize frameSize() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of decoded frames.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 frameCount() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the 8bpp pixels of all frames.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QByteArray &raw() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the 8bpp pixels of one frame.
+        ///
+        /// Points into the buffer of all frames and stays valid
+        /// until the sheet is read again.
+        ///
+        /// \param index Number of the frame
+        /// \returns width * height palette indices, row by row.
+        ///
+        ///////////////////////////////////////////////////////////
+        const UInt8 *frame(Int32 index) const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Copies one frame to a new image.
+        /// \param index Number of the frame
+        ///
+        ///////////////////////////////////////////////////////////
+        Image image(Int32 index) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Decodes the frames within the given tile data.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool convertFromGBA(const UInt8 *data, Int32 length, SpriteShape shape, Int32 size, Boolean is4bpp);
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QByteArray      m_Frames;
+        Int32           m_Width;
+        Int32           m_Height;
+        Int32           m_Count;
+        QString         m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_SPRITESHEET_HPP__
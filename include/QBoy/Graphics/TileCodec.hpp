@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_TILECODEC_HPP__
+#define __QBOY_TILECODEC_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   TileCodec.hpp
+    /// \brief  Converts between tiled and linear pixel data.
+    ///
+    /// GBA graphics are stored as a sequence of 8x8 tiles. The
+    /// codec converts them to one index byte per pixel in row
+    /// order, which is the layout used by qboy::Image, or to
+    /// two pixels per byte for packed 4bpp images. Uses
+    /// SSE2 where available and splits big images into rows of
+    /// tiles that are processed on multiple cores.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API TileCodec {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts one 4bpp tile to linear 8-bit indices.
+        /// \param tile Pointer to the 32 bytes of the tile
+        /// \param output Pointer to the top-left output pixel
+        /// \param stride Distance between two output rows
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decodeTile4bpp(const UInt8 *tile, UInt8 *output, Int32 stride);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts one 8bpp tile to linear 8-bit indices.
+        /// \param tile Pointer to the 64 bytes of the tile
+        /// \param output Pointer to the top-left output pixel
+        /// \param stride Distance between two output rows
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decodeTile8bpp(const UInt8 *tile, UInt8 *output, Int32 stride);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts 4bpp tiles to linear 8-bit indices.
+        ///
+        /// Expects the output to hold width * height bytes. Pixels
+        /// which are not covered by the data are set to zero.
+        ///
+        /// \param data Pointer to the 4bpp tile data
+        /// \param length Length of the tile data in bytes
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the linear output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decode4bpp(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts 8bpp tiles to linear 8-bit indices.
+        ///
+        /// Expects the output to hold width * height bytes. Pixels
+        /// which are not covered by the data are set to zero.
+        ///
+        /// \param data Pointer to the 8bpp tile data
+        /// \param length Length of the tile data in bytes
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the linear output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decode8bpp(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts one 4bpp tile to packed linear pixels.
+        /// \param tile Pointer to the 32 bytes of the tile
+        /// \param output Pointer to the top-left output byte
+        /// \param stride Distance between two output rows in bytes
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decodeTile4bppPacked(const UInt8 *tile, UInt8 *output, Int32 stride);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts 4bpp tiles to packed linear pixels.
+        ///
+        /// Keeps two pixels per byte, the left one in the low
+        /// nibble. Expects the output to hold width * height / 2
+        /// bytes. Pixels not covered by the data are set to zero.
+        ///
+        /// \param data Pointer to the 4bpp tile data
+        /// \param length Length of the tile data in bytes
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the packed output
+        ///
+        ///////////////////////////////////////////////////////////
+        static void decode4bppPacked(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts packed linear pixels to 4bpp tiles.
+        ///
+        /// Expects the output to hold width * height / 2 bytes.
+        ///
+        /// \param input Pointer to the packed pixels
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the 4bpp tile data
+        ///
+        ///////////////////////////////////////////////////////////
+        static void encode4bppPacked(const UInt8 *input, Int32 width, Int32 height, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts linear 8-bit indices to 4bpp tiles.
+        ///
+        /// Expects the output to hold width * height / 2 bytes.
+        /// Only the low nibble of each index is used.
+        ///
+        /// \param input Pointer to the linear indices
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the 4bpp tile data
+        ///
+        ///////////////////////////////////////////////////////////
+        static void encode4bpp(const UInt8 *input, Int32 width, Int32 height, UInt8 *output);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts linear 8-bit indices to 8bpp tiles.
+        ///
+        /// Expects the output to hold width * height bytes.
+        ///
+        /// \param input Pointer to the linear indices
+        /// \param width Width of the image; a multiple of 8
+        /// \param height Height of the image; a multiple of 8
+        /// \param output Pointer to the 8bpp tile data
+        ///
+        ///////////////////////////////////////////////////////////
+        static void encode8bpp(const UInt8 *input, Int32 width, Int32 height, UInt8 *output);
+    };
+}
+
+
+#endif  // __QBOY_TILECODEC_HPP__
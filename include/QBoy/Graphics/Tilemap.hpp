@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_TILEMAP_HPP__
+#define __QBOY_TILEMAP_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rom.hpp>
+#include <QBoy/Graphics/Image.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QBoy/Graphics/Tileset.hpp>
+#include <QList>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Tilemap.hpp
+    /// \brief  Reads and composes text background tilemaps.
+    ///
+    /// Each entry holds a tile number, the flip flags and the
+    /// palette bank, as defined by qboy::TileEntry. Maps wider
+    /// than 32 tiles can be read in the screenblock layout of
+    /// the VRAM, which is converted to plain rows of entries.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Tilemap {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty tilemap.
+        ///
+        ///////////////////////////////////////////////////////////
+        Tilemap();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads an uncompressed tilemap from the rom.
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the tilemap within the rom
+        /// \param width Width of the tilemap in tiles
+        /// \param height Height of the tilemap in tiles
+        /// \param blocks Are the entries stored in 32x32 blocks?
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readUncompressed(
+                const Rom &rom,
+                UInt32 offset,
+                Int32 width,
+                Int32 height,
+                Boolean blocks = false
+        );
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Reads a compressed tilemap from the rom.
+        /// \param rom Currently active rom instance
+        /// \param offset Offset of the tilemap within the rom
+        /// \param width Width of the tilemap in tiles
+        /// \param blocks Are the entries stored in 32x32 blocks?
+        /// \returns the success of the procedure.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool readCompressed(
+                const Rom &rom,
+                UInt32 offset,
+                Int32 width,
+                Boolean blocks = false
+        );
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the entries, row by row.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QVector<UInt16> &entries() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of the tilemap in tiles.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSize size() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Specifies the entries, row by row.
+        /// \param entries Tilemap entries, e.g. of a qboy::Tileset
+        /// \param width Width of the tilemap in tiles
+        /// \returns false if the count is not a multiple of width.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool setEntries(const QVector<UInt16> &entries, Int32 width);
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Composes the tilemap to palette indices.
+        ///
+        /// Tile numbers count through the tiles of the image row
+        /// by row. Numbers beyond the image yield index zero.
+        /// For 4bpp tiles, the palette bank of each entry forms
+        /// the upper four bits of the index.
+        ///
+        /// \param tiles Image holding the tiles
+        /// \param is4bpp Are the tiles 4bpp or 8bpp?
+        /// \returns one index per pixel, row by row.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray composeIndexed(const Image &tiles, Boolean is4bpp) const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Composes the tilemap to RGBA colors.
+        ///
+        /// For 4bpp tiles, the palette bank of each entry selects
+        /// one of the given palettes; 8bpp tiles always use the
+        /// first one. Missing palettes yield transparent pixels.
+        ///
+        /// \param tiles Image holding the tiles
+        /// \param palettes Palettes, one per bank
+        /// \param is4bpp Are the tiles 4bpp or 8bpp?
+        /// \returns one color per pixel, row by row.
+        ///
+        ///////////////////////////////////////////////////////////
+        QVector<Color> compose(
+                const Image &tiles,
+                const QList<const Palette *> &palettes,
+                Boolean is4bpp
+        ) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts the read entries to plain rows.
+        /// \param entries Entries as stored in the rom
+        /// \param width Width of the tilemap in tiles
+        /// \param blocks Are the entries stored in 32x32 blocks?
+        ///
+        ///////////////////////////////////////////////////////////
+        bool convertGBA(const QList<UInt16> &entries, Int32 width, Boolean blocks);
+
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QVector<UInt16>     m_Entries;
+        Int32               m_Width;
+        Int32               m_Height;
+        QString             m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_TILEMAP_HPP__
@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_TILEMAPERRORS_HPP__
+#define __QBOY_TILEMAPERRORS_HPP__
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   TilemapErrors.hpp
+    /// \brief  Defines several error strings for tilemaps.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    #define MAP_ERROR_OFFSET    "Given tilemap offset is out of rom range."
+    #define MAP_ERROR_LZ77      "The LZ77 data of the tilemap is broken."
+    #define MAP_ERROR_SIZE      "The entry count is not a multiple of the width or the blocks are incomplete."
+    #define MAP_ERROR_AFFINE    "The affine tilemap is not 16, 32, 64 or 128 tiles in size."
+}
+
+
+#endif  // __QBOY_TILEMAPERRORS_HPP__
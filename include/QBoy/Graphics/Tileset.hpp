@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_TILESET_HPP__
+#define __QBOY_TILESET_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Image.hpp>
+#include <QVector>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \brief Defines the bits of a text background map entry.
+    ///
+    ///////////////////////////////////////////////////////////
+    enum TileEntry : int
+    {
+        TE_IndexMask    = 0x03FF,
+        TE_HFlip        = 0x0400,
+        TE_VFlip        = 0x0800,
+        TE_PaletteMask  = 0xF000
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Tileset.hpp
+    /// \brief  Splits an image into its unique tiles.
+    ///
+    /// Stores every distinct 8x8 tile of an image once. Tiles
+    /// that equal a stored one when mirrored horizontally or
+    /// vertically are not stored again, but referenced with
+    /// the flip flags of a tilemap entry instead.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API Tileset {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty tileset.
+        ///
+        ///////////////////////////////////////////////////////////
+        Tileset();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Builds the tileset from the given image.
+        ///
+        /// Splits the image into tiles, row by row, and keeps the
+        /// first occurrence of each distinct tile. Also creates
+        /// one tilemap entry per tile of the image.
+        ///
+        /// \param image Image to split; any bit depth
+        /// \param detectFlips Should flipped tiles be merged?
+        /// \returns false if there are more than 1024 unique tiles.
+        ///
+        ///////////////////////////////////////////////////////////
+        bool fromImage(const Image &image, Boolean detectFlips = true);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Returns the last error beeing thrown.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of unique tiles.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 count() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the pixels of the unique tiles.
+        ///
+        /// Holds 64 bytes per tile, one palette index per pixel,
+        /// row by row. Equals an 8 pixels wide image.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QByteArray &tiles() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the tilemap entries of the image.
+        ///
+        /// Each entry holds the tile number and the flip flags,
+        /// as defined by qboy::TileEntry.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QVector<UInt16> &entries() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the size of the tilemap in tiles.
+        ///
+        ///////////////////////////////////////////////////////////
+        QSize mapSize() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Converts the unique tiles to GBA tile data.
+        /// \param is4bpp Should the tiles be 4bpp or 8bpp?
+        /// \returns 32 or 64 bytes per tile.
+        ///
+        ///////////////////////////////////////////////////////////
+        QByteArray toGBA(Boolean is4bpp) const;
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QByteArray          m_Tiles;
+        QVector<UInt16>     m_Entries;
+        Int32               m_Columns;
+        Int32               m_Rows;
+        QString             m_LastError;
+    };
+}
+
+
+#endif  // __QBOY_TILESET_HPP__
@@ -30,10 +30,12 @@
 ///////////////////////////////////////////////////////////
 #include <QBoy/Config.hpp>
 #include <QBoy/Graphics/Color.hpp>
+#include <QBoy/OpenGL/PaletteBank.hpp>
 #include <QOpenGLFunctions>
 #include <QOpenGLWidget>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
+#include <QVector>
 
 
 namespace qboy
@@ -69,23 +71,50 @@ namespace qboy
 
         ///////////////////////////////////////////////////////////
         /// \brief Sets the 8bpp pixel data for the texture.
+        ///
+        /// Packed data holds two pixels per byte, the left one in
+        /// the low nibble. It is uploaded as it is and unpacked
+        /// by the fragment shader.
+        ///
         /// \param pixels Byte array containing the pixel data
         /// \param width Width of the image
         /// \param height Height of the image
+        /// \param packed Is the data packed 4bpp data?
         ///
         ///////////////////////////////////////////////////////////
-        void setImage(UInt8 *pixels, Int32 width, Int32 height);
+        void setImage(UInt8 *pixels, Int32 width, Int32 height, Boolean packed = false);
 
         ///////////////////////////////////////////////////////////
         /// \brief Sets the palette data for the texture.
-        /// \param palette Integer array containing the RGBA data
+        ///
+        /// The colors are copied; the texture keeps its own 256
+        /// entries, padded with transparent black.
+        ///
+        /// \param palette Array containing the RGBA data
+        /// \param count Amount of colors within the array
+        ///
+        ///////////////////////////////////////////////////////////
+        void setPalette(const GLColor *palette, Int32 count = 256);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Uses a palette within a shared palette bank.
+        ///
+        /// The texture then owns no palette of its own; pixels
+        /// are looked up at the given offset within the bank.
+        ///
+        /// \param bank Bank containing the palette
+        /// \param offset Offset returned by qboy::PaletteBank::add
         ///
         ///////////////////////////////////////////////////////////
-        void setPalette(GLColor *palette);
+        void setPalette(PaletteBank *bank, Int32 offset);
 
 
         ///////////////////////////////////////////////////////////
         /// \brief Updates 8bpp pixel data in a specific region.
+        ///
+        /// For packed textures, the pixels must be packed as well
+        /// and the x-position and the width must be even.
+        ///
         /// \param pixels Byte array containing the pixel data
         /// \param xpos X-position to update pixel data from
         /// \param ypos Y-position to update pixel data from
@@ -136,11 +165,14 @@ namespace qboy
         ///////////////////////////////////////////////////////////
         Int32               m_Width;
         Int32               m_Height;
+        Boolean             m_IsPacked;
         UInt32              m_PaletteID;
         UInt32              m_TextureID;
         UInt32              m_VertexBuffer;
         UInt32              m_IndexBuffer;
-        GLColor            *m_Colors;
+        QVector<GLColor>    m_Colors;
+        PaletteBank        *m_Bank;
+        Int32               m_PaletteOffset;
         UInt8              *m_Pixels;
         Float              *m_Buffer;
         QOpenGLFunctions   *m_Functions;
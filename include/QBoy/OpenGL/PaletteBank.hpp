@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+#ifndef __QBOY_PALETTEBANK_HPP__
+#define __QBOY_PALETTEBANK_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+#include <QBoy/Graphics/Palette.hpp>
+#include <QOpenGLFunctions>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   PaletteBank.hpp
+    /// \brief  Gathers many palettes within one texture.
+    ///
+    /// Holds a table of 256 colors per row. A 256-color palette
+    /// occupies a whole row, 16-color palettes share rows with
+    /// up to fifteen others. Each palette is addressed by the
+    /// index of its first color, which textures pass to their
+    /// shader; thus one texture serves every palette.
+    ///
+    ///////////////////////////////////////////////////////////
+    class QBOY_API PaletteBank {
+    public:
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default constructor
+        ///
+        /// Initializes an empty table without a texture.
+        ///
+        ///////////////////////////////////////////////////////////
+        PaletteBank();
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Default destructor
+        ///
+        /// Destroys the palette texture within OpenGL.
+        ///
+        ///////////////////////////////////////////////////////////
+        ~PaletteBank();
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Copy constructor
+        ///
+        /// Disables copying, as the bank owns an OpenGL texture.
+        ///
+        ///////////////////////////////////////////////////////////
+        PaletteBank(const PaletteBank &bank) = delete;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Appends a 16- or 256-color palette to the table.
+        ///
+        /// The 16 banks of a 256-color palette stay addressable
+        /// by adding (bank * 16) to the returned offset.
+        ///
+        /// \param palette Palette to copy the colors from
+        /// \returns the offset of the first color or -1.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 add(const Palette &palette);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Replaces the colors of an added palette.
+        /// \param offset Offset returned by qboy::PaletteBank::add
+        /// \param palette Palette with the same color count
+        ///
+        ///////////////////////////////////////////////////////////
+        bool update(Int32 offset, const Palette &palette);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Replaces one color within the table.
+        /// \param index Absolute index of the color
+        /// \param color New color of the entry
+        ///
+        ///////////////////////////////////////////////////////////
+        void updateColor(Int32 index, const Color &color);
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Removes all palettes from the table.
+        ///
+        /// The texture is kept and reused for the new palettes.
+        ///
+        ///////////////////////////////////////////////////////////
+        void clear();
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the color table, 256 colors per row.
+        ///
+        ///////////////////////////////////////////////////////////
+        const QVector<Color> &table() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the amount of occupied rows.
+        ///
+        ///////////////////////////////////////////////////////////
+        Int32 rows() const;
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the OpenGL texture of the table.
+        ///
+        /// Uploads any pending changes of the table first.
+        ///
+        ///////////////////////////////////////////////////////////
+        UInt32 texture();
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Retrieves the last error upon adding palettes.
+        /// \returns the last error (no stacking!).
+        ///
+        ///////////////////////////////////////////////////////////
+        const QString &lastError() const;
+
+
+        ///////////////////////////////////////////////////////////
+        /// \brief Sets the current OpenGL functions context.
+        ///
+        ///////////////////////////////////////////////////////////
+        void setOpenGLFunctions(QOpenGLFunctions *functions);
+
+
+    private:
+
+        ///////////////////////////////////////////////////////////
+        // Class members
+        //
+        ///////////////////////////////////////////////////////////
+        QVector<Color>      m_Table;
+        Int32               m_Rows;
+        Int32               m_NextBank;
+        Int32               m_DirtyFirst;
+        Int32               m_DirtyLast;
+        Int32               m_Capacity;
+        UInt32              m_TextureID;
+        QString             m_LastError;
+        QOpenGLFunctions   *m_Functions;
+    };
+}
+
+
+#endif  // __QBOY_PALETTEBANK_HPP__
@@ -18,12 +18,31 @@ out vec4 out_color;
 uniform sampler2D smp_palette;
 uniform sampler2D smp_texture;
 
+// Uniform variables
+uniform int uni_packed;
+uniform int uni_offset;
+
 
 /* Maps pixel indices to colors */
 void main()
 {
-    vec4 index = texture(smp_texture, frag_coords);
-    vec4 texel = texture(smp_palette, index.xy);
+    int index;
+    if (uni_packed != 0)
+    {
+        // Every texel holds two pixels; the left one in the low nibble
+        ivec2 size  = textureSize(smp_texture, 0);
+        ivec2 pixel = min(ivec2(frag_coords * vec2(size.x * 2, size.y)), ivec2(size.x * 2 - 1, size.y - 1));
+        int   pair  = int(texelFetch(smp_texture, ivec2(pixel.x / 2, pixel.y), 0).r * 255.0 + 0.5);
+        index = ((pixel.x & 1) == 1) ? (pair >> 4) : (pair & 15);
+    }
+    else
+    {
+        index = int(texture(smp_texture, frag_coords).r * 255.0 + 0.5);
+    }
+
+    // The palette texture holds 256 colors per row
+    index += uni_offset;
+    vec4 texel = texelFetch(smp_palette, ivec2(index & 255, index >> 8), 0);
 
     // (Applies blending value for DNS implementations)
     // out_color = texel * vec4(frag_tint, 1.0);
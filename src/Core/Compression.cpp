@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Compression.hpp>
+#include <QBoy/Core/Diff.hpp>
+#include <QBoy/Core/Huffman.hpp>
+#include <QBoy/Core/Lz77.hpp>
+#include <QBoy/Core/Rle.hpp>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    struct CompressionCandidate
+    {
+        CompressionType type;
+        QByteArray encoded;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    CompressionType Compression::type(const Rom &rom, UInt32 offset)
+    {
+        if (!rom.checkOffset(offset))
+            return CT_None;
+
+        switch (rom.data()[offset]) {
+        case CT_Lz77:
+        case CT_Huffman4:
+        case CT_Huffman8:
+        case CT_Rle:
+        case CT_Diff8:
+        case CT_Diff16:
+            return static_cast<CompressionType>(rom.data()[offset]);
+        default:
+            return CT_None;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Compression::decompress(const Rom &rom, UInt32 offset, Int32 *size)
+    {
+        switch (type(rom, offset)) {
+        case CT_Lz77:
+            return Lz77::decompress(rom, offset, size);
+        case CT_Huffman4:
+        case CT_Huffman8:
+            return Huffman::decompress(rom, offset, size);
+        case CT_Rle:
+            return Rle::decompress(rom, offset, size);
+        case CT_Diff8:
+        case CT_Diff16:
+            return Diff::unfilter(rom, offset, size);
+        default:
+            return QByteArray(NULL);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Compression::decompress(const QByteArray &data, Int32 *size)
+    {
+        if (data.isEmpty())
+            return QByteArray(NULL);
+
+        switch ((UInt8)data.at(0)) {
+        case CT_Lz77:
+            return Lz77::decompress(data, size);
+        case CT_Huffman4:
+        case CT_Huffman8:
+            return Huffman::decompress(data, size);
+        case CT_Rle:
+            return Rle::decompress(data, size);
+        case CT_Diff8:
+        case CT_Diff16:
+            return Diff::unfilter(data, size);
+        default:
+            return QByteArray(NULL);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Compression::compress(const QByteArray &raw, CompressionType type)
+    {
+        switch (type) {
+        case CT_Lz77:
+            return Lz77::compress(raw);
+        case CT_Huffman4:
+            return Huffman::compress(raw, 4);
+        case CT_Huffman8:
+            return Huffman::compress(raw, 8);
+        case CT_Rle:
+            return Rle::compress(raw);
+        case CT_Diff8:
+            return Diff::filter(raw, 8);
+        case CT_Diff16:
+            return Diff::filter(raw, 16);
+        default:
+            return QByteArray(NULL);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Compression::compressBest(const QByteArray &raw, CompressionType *type)
+    {
+        QVector<CompressionCandidate> candidates;
+        candidates.push_back({ CT_Lz77, QByteArray() });
+        candidates.push_back({ CT_Rle, QByteArray() });
+        candidates.push_back({ CT_Huffman4, QByteArray() });
+        candidates.push_back({ CT_Huffman8, QByteArray() });
+
+
+        // Encodes the data in every format and discards the results
+        // that fail to reproduce the original data.
+        QtConcurrent::blockingMap(candidates, [&raw](CompressionCandidate &candidate)
+        {
+            candidate.encoded = compress(raw, candidate.type);
+
+            Int32 size = 0;
+            if (candidate.encoded.isNull() || decompress(candidate.encoded, &size) != raw)
+                candidate.encoded.clear();
+        });
+
+        int best = -1;
+        for (int i = 0; i < candidates.size(); i++)
+        {
+            const QByteArray &encoded = candidates.at(i).encoded;
+            if (!encoded.isEmpty() && (best < 0 || encoded.size() < candidates.at(best).encoded.size()))
+                best = i;
+        }
+
+
+        if (best < 0)
+        {
+            type[0] = CT_None;
+            return QByteArray(NULL);
+        }
+
+        type[0] = candidates.at(best).type;
+        return candidates.at(best).encoded;
+    }
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Diff.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    QByteArray diff_decode(const UInt8 *data, Int32 available, Int32 *size)
+    {
+        if (available < 4 || (data[0] != 0x81 && data[0] != 0x82))
+            return QByteArray(NULL);
+
+        // Retrieves the unit size and the length of the data
+        Int32 unit = data[0] & 0xF;
+        Int32 length = data[1] | (data[2] << 8) | (data[3] << 16);
+        if (length % unit != 0 || 4 + length > available)
+            return QByteArray(NULL);
+
+        QByteArray decomp;
+        decomp.resize(length);
+        UInt8 *output = reinterpret_cast<UInt8 *>(decomp.data());
+        const UInt8 *input = data + 4;
+
+
+        // Accumulates the differences
+        if (unit == 1)
+        {
+            UInt8 value = 0;
+            for (Int32 i = 0; i < length; i++)
+                output[i] = (value += input[i]);
+        }
+        else
+        {
+            UInt16 value = 0;
+            for (Int32 i = 0; i < length; i += 2)
+            {
+                value += (UInt16)(input[i] | (input[i+1] << 8));
+                output[i+0] = (UInt8)(value & 0xFF);
+                output[i+1] = (UInt8)(value >> 8);
+            }
+        }
+
+
+        size[0] = 4 + length;
+        return decomp;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Diff::unfilter(const Rom &rom, UInt32 offset, Int32 *size)
+    {
+        if (!rom.checkOffset(offset))
+            return QByteArray(NULL);
+
+        return diff_decode(rom.data() + offset, rom.size() - offset, size);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Diff::unfilter(const QByteArray &data, Int32 *size)
+    {
+        return diff_decode(reinterpret_cast<const UInt8 *>(data.constData()), data.size(), size);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Diff::filter(const QByteArray &raw, Int32 bits)
+    {
+        Q_ASSERT(bits == 8 || bits == 16);
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        Int32 size = raw.size();
+        if (size % (bits / 8) != 0)
+            return QByteArray(NULL);
+
+        // Writes the header and the data length
+        QByteArray filtered;
+        filtered.resize((4 + size + 3) & ~3);
+        UInt8 *output = reinterpret_cast<UInt8 *>(filtered.data());
+        output[0] = (UInt8)(0x80 | (bits / 8));
+        output[1] = (UInt8)(size & 0xFF);
+        output[2] = (UInt8)((size >> 8) & 0xFF);
+        output[3] = (UInt8)((size >> 16) & 0xFF);
+
+
+        // Stores the difference of each unit to the previous one
+        if (bits == 8)
+        {
+            UInt8 previous = 0;
+            for (Int32 i = 0; i < size; i++)
+            {
+                output[4+i] = (UInt8)(data[i] - previous);
+                previous = data[i];
+            }
+        }
+        else
+        {
+            UInt16 previous = 0;
+            for (Int32 i = 0; i < size; i += 2)
+            {
+                UInt16 value = (UInt16)(data[i] | (data[i+1] << 8));
+                UInt16 delta = (UInt16)(value - previous);
+                output[4+i+0] = (UInt8)(delta & 0xFF);
+                output[4+i+1] = (UInt8)(delta >> 8);
+                previous = value;
+            }
+        }
+
+        // Aligns the data length to four
+        for (Int32 i = 4 + size; i < filtered.size(); i++)
+            output[i] = 0;
+
+        return filtered;
+    }
+}
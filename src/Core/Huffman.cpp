@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Huffman.hpp>
+#include <QPair>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define HUFFMAN_MAX_OFFSET  63
+
+    ///////////////////////////////////////////////////////////
+    struct HuffmanNode
+    {
+        Int32 symbol;       // -1 denotes an internal node
+        Int32 child[2];
+    };
+
+    ///////////////////////////////////////////////////////////
+    struct HuffmanCode
+    {
+        UInt64 bits;
+        Int32 length;
+    };
+
+    ///////////////////////////////////////////////////////////
+    struct HuffmanPending
+    {
+        Int32 node;
+        Int32 address;
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    QByteArray huffman_decode(const UInt8 *data, Int32 available, Int32 *size)
+    {
+        if (available < 6 || (data[0] != 0x24 && data[0] != 0x28))
+            return QByteArray(NULL);
+
+        // Retrieves the length and the location of the bit stream
+        Int32 bits = data[0] & 0xF;
+        Int32 length = data[1] | (data[2] << 8) | (data[3] << 16);
+        const UInt8 *tree = data + 4;
+        Int32 treeSize = (tree[0] + 1) * 2;
+        Int32 input = 4 + treeSize;
+        if (input > available)
+            return QByteArray(NULL);
+
+        QByteArray decomp;
+        decomp.resize(length);
+        UInt8 *output = reinterpret_cast<UInt8 *>(decomp.data());
+        std::fill(output, output + length, 0);
+
+
+        // Follows the tree for every bit, MSB first, until a leaf
+        // is reached. The leaf holds the next data unit.
+        Int32 node = 1;
+        Int32 units = length * 8 / bits;
+        Int32 unit = 0;
+        while (unit < units)
+        {
+            if (input + 4 > available)
+                return QByteArray(NULL);
+
+            UInt32 word = data[input] | (data[input+1] << 8) | (data[input+2] << 16) | ((UInt32)data[input+3] << 24);
+            input += 4;
+
+            for (int i = 31; i >= 0 && unit < units; i--)
+            {
+                Int32 bit = (word >> i) & 1;
+                Int32 child = (node & ~1) + (tree[node] & 0x3F) * 2 + 2 + bit;
+                if (child >= treeSize)
+                    return QByteArray(NULL);
+
+                if ((tree[node] & (0x80 >> bit)) == 0)
+                {
+                    node = child;
+                    continue;
+                }
+
+                // Units smaller than a byte fill it from the lowest bit on
+                if (bits == 8)
+                    output[unit] = tree[child];
+                else
+                    output[unit/2] |= (UInt8)((tree[child] & 0xF) << ((unit % 2) * 4));
+
+                unit++;
+                node = 1;
+            }
+        }
+
+
+        size[0] = input;
+        return decomp;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Huffman::decompress(const Rom &rom, UInt32 offset, Int32 *size)
+    {
+        if (!rom.checkOffset(offset))
+            return QByteArray(NULL);
+
+        return huffman_decode(rom.data() + offset, rom.size() - offset, size);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Huffman::decompress(const QByteArray &data, Int32 *size)
+    {
+        return huffman_decode(reinterpret_cast<const UInt8 *>(data.constData()), data.size(), size);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    /// Chooses the node whose children are stored next. The
+    /// most recently added node is taken, which keeps the list
+    /// short, unless older nodes run out of reachable slots.
+    ///
+    ///////////////////////////////////////////////////////////
+    int huffman_pick(const QVector<HuffmanPending> &pending, Int32 pair)
+    {
+        QVector<int> order;
+        for (int i = 0; i < pending.size(); i++)
+            order.push_back(i);
+
+        std::stable_sort(order.begin(), order.end(), [&pending](int a, int b)
+        {
+            return pending.at(a).address < pending.at(b).address;
+        });
+
+        for (int rank = 0; rank < order.size(); rank++)
+        {
+            Int32 deadline = pending.at(order.at(rank)).address / 2 + HUFFMAN_MAX_OFFSET + 1;
+            if (deadline - pair <= rank)
+                return order.at(rank);
+        }
+
+        return pending.size() - 1;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Stores the tree as the BIOS expects it: one byte per
+    /// node, children in pairs, and a six-bit offset from each
+    /// node to the pair of its children.
+    ///
+    ///////////////////////////////////////////////////////////
+    bool huffman_table(const QVector<HuffmanNode> &nodes, Int32 root, QByteArray *table)
+    {
+        Int32 pairs = (nodes.size() - 1) / 2;
+        Int32 tableSize = (2 + pairs * 2 + 3) & ~3;
+        table->fill(0, tableSize);
+        (*table)[0] = (char)(tableSize / 2 - 1);
+
+
+        QVector<HuffmanPending> pending;
+        pending.push_back({ root, 1 });
+
+        Int32 pair = 1;
+        while (!pending.isEmpty())
+        {
+            int index = huffman_pick(pending, pair);
+            HuffmanPending current = pending.at(index);
+            pending.remove(index);
+
+            Int32 offset = pair - current.address / 2 - 1;
+            if (offset > HUFFMAN_MAX_OFFSET)
+                return false;
+
+            // Leaves are written right away, nodes once they are picked
+            const HuffmanNode &node = nodes.at(current.node);
+            UInt8 value = (UInt8)offset;
+            for (int side = 0; side < 2; side++)
+            {
+                const HuffmanNode &child = nodes.at(node.child[side]);
+                if (child.symbol >= 0)
+                {
+                    (*table)[pair*2 + side] = (char)child.symbol;
+                    value |= (UInt8)(0x80 >> side);
+                }
+                else
+                {
+                    pending.push_back({ node.child[side], pair*2 + side });
+                }
+            }
+
+            (*table)[current.address] = (char)value;
+            pair++;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void huffman_codes(const QVector<HuffmanNode> &nodes, Int32 index, HuffmanCode code, QVector<HuffmanCode> &codes)
+    {
+        const HuffmanNode &node = nodes.at(index);
+        if (node.symbol >= 0)
+        {
+            codes[node.symbol] = code;
+            return;
+        }
+
+        for (int side = 0; side < 2; side++)
+            huffman_codes(nodes, node.child[side], { (code.bits << 1) | side, code.length + 1 }, codes);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void huffman_word(QByteArray &encoded, UInt32 word)
+    {
+        encoded.append((char)(word & 0xFF));
+        encoded.append((char)((word >> 8) & 0xFF));
+        encoded.append((char)((word >> 16) & 0xFF));
+        encoded.append((char)((word >> 24) & 0xFF));
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Huffman::compress(const QByteArray &raw, Int32 bits)
+    {
+        Q_ASSERT(bits == 4 || bits == 8);
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        Int32 size = raw.size();
+        Int32 units = size * 8 / bits;
+        Int32 symbols = 1 << bits;
+
+        // Counts the occurrences of each data unit
+        QVector<Int32> counts(symbols, 0);
+        for (Int32 i = 0; i < units; i++)
+            counts[(bits == 8) ? data[i] : ((data[i/2] >> ((i % 2) * 4)) & 0xF)]++;
+
+
+        // Builds the tree; ties are resolved by node index to keep
+        // the output deterministic. A tree needs at least two leaves.
+        typedef QPair<Int64, Int32> Weight;
+        std::priority_queue<Weight, std::vector<Weight>, std::greater<Weight>> queue;
+        QVector<HuffmanNode> nodes;
+        for (Int32 symbol = 0; symbol < symbols; symbol++)
+        {
+            if (counts.at(symbol) > 0 || (nodes.size() < 2 && symbols - symbol <= 2 - nodes.size()))
+            {
+                queue.push(Weight(counts.at(symbol), nodes.size()));
+                nodes.push_back({ symbol, { -1, -1 } });
+            }
+        }
+
+        while (queue.size() > 1)
+        {
+            Weight first = queue.top(); queue.pop();
+            Weight second = queue.top(); queue.pop();
+            queue.push(Weight(first.first + second.first, nodes.size()));
+            nodes.push_back({ -1, { first.second, second.second } });
+        }
+
+        QByteArray table;
+        if (!huffman_table(nodes, nodes.size() - 1, &table))
+            return QByteArray(NULL);
+
+        QVector<HuffmanCode> codes(symbols);
+        huffman_codes(nodes, nodes.size() - 1, { 0, 0 }, codes);
+
+
+        // Writes the header and the tree
+        QByteArray encoded;
+        encoded.reserve(4 + table.size() + size + 4);
+        encoded.append((char)(0x20 | bits));
+        encoded.append((char)(size & 0xFF));
+        encoded.append((char)((size >> 8) & 0xFF));
+        encoded.append((char)((size >> 16) & 0xFF));
+        encoded.append(table);
+
+        // Writes the codes MSB first into little-endian words
+        UInt32 word = 0;
+        Int32 count = 0;
+        for (Int32 i = 0; i < units; i++)
+        {
+            Int32 symbol = (bits == 8) ? data[i] : ((data[i/2] >> ((i % 2) * 4)) & 0xF);
+            const HuffmanCode &code = codes.at(symbol);
+            for (int b = code.length - 1; b >= 0; b--)
+            {
+                word |= (UInt32)((code.bits >> b) & 1) << (31 - count);
+                if (++count == 32)
+                {
+                    huffman_word(encoded, word);
+                    word = 0;
+                    count = 0;
+                }
+            }
+        }
+
+        if (count > 0)
+            huffman_word(encoded, word);
+
+        return encoded;
+    }
+}
@@ -25,59 +25,61 @@
 //
 ///////////////////////////////////////////////////////////
 #include <QBoy/Core/Lz77.hpp>
-#include <QList>
+#include <QBoy/Core/Lz77Errors.hpp>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cstring>
 
 
 namespace qboy
 {
     ///////////////////////////////////////////////////////////
-    QByteArray Lz77::decompress(const Rom &rom, UInt32 offset, Int32 *size)
+    Int32 lz77_length(const UInt8 *data, Int32 available)
     {
-        UInt8 *start = rom.data() + offset;
-        UInt8 *array = rom.data() + offset;
-        if (*array++ != 0x10)
-            return QByteArray(NULL);
-
-        // Instantiates a byte array
-        QByteArray decomp;
+        if (available < 4 || data[0] != 0x10)
+            return -1;
 
-        // Retrieves the length of the LZ77 data
-        int position = 0;
-        int length = (*(array++) + (*(array++) << 8) + (*(array++) << 16));
-        decomp.resize(length);
+        return data[1] | (data[2] << 8) | (data[3] << 16);
+    }
 
+    ///////////////////////////////////////////////////////////
+    Int32 lz77_decode(const UInt8 *data, Int32 available, UInt8 *output, Int32 length)
+    {
+        Int32 input = 4;
+        Int32 position = 0;
 
         // Reads the LZ77 data and checks for compressed and uncompressed blocks
         while (position < length)
         {
-            UInt8 isDecoded = *(array++);
-            for (int i = 0; i < 8; i++)
+            if (input >= available)
+                return -1;
+
+            UInt8 isDecoded = data[input++];
+            for (int i = 0; i < 8 && position < length; i++)
             {
                 if ((isDecoded & 0x80) != 0)
                 {
-                    int count = ((*(array) >> 4) + 3);
-                    int depos = ((((*(array++) & 0xF) << 8) + *(array++)) + 1);
-                    if (depos > length)
-                        return QByteArray(NULL);
+                    if (input + 2 > available)
+                        return -1;
 
-                    // Compressed data which needs to be decoded
-                    for (int j = 0; j < count; j++)
-                    {
-                        if (position >= length)
-                            break;
+                    int count = ((data[input] >> 4) + 3);
+                    int depos = ((((data[input] & 0xF) << 8) | data[input+1]) + 1);
+                    input += 2;
+                    if (depos > position)
+                        return -1;
 
-                        decomp[position] = decomp.at((position-j)-depos+(j%depos));
-                        position++;
-                    }
+                    // Compressed data which needs to be decoded
+                    for (int j = 0; j < count && position < length; j++, position++)
+                        output[position] = output[position-depos];
                 }
                 else
                 {
+                    if (input >= available)
+                        return -1;
+
                     // Uncompressed data which needs to be copied
-                    decomp[position++] = *(array++);
-                }
-                if (position >= length)
-                {
-                    break;
+                    output[position++] = data[input++];
                 }
 
                 isDecoded <<= 1;
@@ -86,100 +88,872 @@ namespace qboy
 
 
         // The compressed size is the current position minus the initial one
-        size[0] = (array - start);
-        return decomp;
+        return input;
     }
 
     ///////////////////////////////////////////////////////////
-    int *attempt_encode(const Int8 *ptr, int pos, int len) // always 2 entries
+    QByteArray lz77_decode(const UInt8 *data, Int32 available, Int32 *size)
     {
-        // Checks whether the following data can be encoded
-        if (pos >= len)
-            return new int[2] { -1, 0 };
-        if ((pos < 2) || (len-pos) < 2)
-            return new int[2] { 0, 0 };
+        // Retrieves the length of the LZ77 data
+        Int32 length = lz77_length(data, available);
+        if (length < 0)
+            return QByteArray(NULL);
 
-        // Encodes the block
-        QList<int> l_pos;
-        for (int i = 1; (i < 4096) && (i < pos); i++)
-            if (ptr[pos-(i+1)] == ptr[pos])
-               l_pos.append(i+1);
+        // Instantiates a byte array
+        QByteArray decomp;
+        decomp.resize(length);
 
-        if (l_pos.size() == 0)
-            return new int[2] { 0, 0 };
+        Int32 input = lz77_decode(data, available, reinterpret_cast<UInt8 *>(decomp.data()), length);
+        if (input < 0)
+            return QByteArray(NULL);
 
+        size[0] = input;
+        return decomp;
+    }
 
-       int count = 0;
-       bool islz = true;
-       while (count++ < 18 && islz)
-       {
-           for (int i = l_pos.size()-1; i >= 0; i--)
-           {
-               if (ptr[pos+count] != ptr[(pos-l_pos[i])+(count%l_pos[i])])
-                   l_pos.removeAt(i);
-               else
-                   islz = false;
-           }
-       }
+    ///////////////////////////////////////////////////////////
+    QByteArray Lz77::decompress(const Rom &rom, UInt32 offset, Int32 *size)
+    {
+        if (!rom.checkOffset(offset))
+            return QByteArray(NULL);
+
+        // Looks for the decoded data of a previous call first
+        QByteArray decomp = rom.cache().find(rom.data(), rom.size(), offset, size);
+        if (!decomp.isNull())
+            return decomp;
+
+        decomp = lz77_decode(rom.data() + offset, rom.size() - offset, size);
+        if (!decomp.isNull())
+            rom.cache().insert(rom.data(), offset, size[0], decomp);
 
-       return new int[2] { count, l_pos[0] };
+        return decomp;
     }
 
     ///////////////////////////////////////////////////////////
-    QByteArray Lz77::compress(const QByteArray &raw)
+    QByteArray Lz77::decompress(const QByteArray &data, Int32 *size)
     {
-        QByteArray encoded;
-        encoded.append(0x10);
-        int position = 0;
-        int size = raw.size();
+        return lz77_decode(reinterpret_cast<const UInt8 *>(data.constData()), data.size(), size);
+    }
 
-        // Computes the data length
-        Int8 *pSize = (Int8*)(&size);
-        encoded.append(*pSize++);
-        encoded.append(*pSize++);
-        encoded.append(*pSize++);
+    ///////////////////////////////////////////////////////////
+    // Decoder definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define LZ77_ARENA_LIMIT    0x40000000
+    #define LZ77_RING_SIZE      0x2000  // power of two; holds the window and a tile
 
 
-        // Encodes the data in blocks
-        while (position < size)
-        {
-            QByteArray block;
-            Int8 bEnc = 0;
+    ///////////////////////////////////////////////////////////
+    Int32 Lz77::decompressedSize(const Rom &rom, UInt32 offset)
+    {
+        if (!rom.checkOffset(offset))
+            return -1;
+
+        return lz77_length(rom.data() + offset, rom.size() - offset);
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 Lz77::decompressTiles(const Rom &rom, UInt32 offset, Int32 tileSize, const Lz77TileFunc &func, Int32 *size, Boolean cache)
+    {
+        Q_ASSERT(tileSize > 0 && LZ77_RING_SIZE % tileSize == 0);
+        Int32 length = decompressedSize(rom, offset);
+        if (length < 0)
+            return -1;
 
-            for (int j = 0; j < 8; j++)
+        // Passes the tiles of previously decoded data right away
+        QByteArray decomp = rom.cache().find(rom.data(), rom.size(), offset, size);
+        if (!decomp.isNull() && decomp.size() == length)
+        {
+            const UInt8 *tiles = reinterpret_cast<const UInt8 *>(decomp.constData());
+            QByteArray last(tileSize, 0);
+            for (Int32 tile = 0; tile * tileSize < length; tile++)
             {
-                int *row = attempt_encode(raw.data(), position, size);
-                if (row[0] > 2)
+                if ((tile + 1) * tileSize <= length)
+                    func(tiles + tile * tileSize, tile);
+                else
                 {
-                    // Can be Lz77 encoded
-                    Int8 lo = (Int8)((((row[0]-3)&0xF)<<4)+(((row[1]-1)>>8)&0xF));
-                    Int8 hi = (Int8)((row[1]-1)&0xFF);
-
-                    block.append(lo);
-                    block.append(hi);
-                    position += row[0];
-                    bEnc |= (Int8)(1 << (8-(j+1)));
+                    std::memcpy(last.data(), tiles + tile * tileSize, length - tile * tileSize);
+                    func(reinterpret_cast<const UInt8 *>(last.constData()), tile);
                 }
-                else if (row[0] >= 0)
+            }
+
+            return length;
+        }
+
+
+        // Decodes into a buffer for the cache if requested and it can
+        // keep the data. Otherwise, decodes into a small ring buffer that
+        // only holds the window of the back-references plus the current tile.
+        Boolean keep = cache && (length <= rom.cache().budget());
+        Int32 mask = -1;
+        if (keep)
+        {
+            decomp.resize(length);
+        }
+        else
+        {
+            decomp.resize(LZ77_RING_SIZE);
+            mask = LZ77_RING_SIZE - 1;
+        }
+
+        const UInt8 *data = rom.data() + offset;
+        Int32 available = rom.size() - offset;
+        UInt8 *output = reinterpret_cast<UInt8 *>(decomp.data());
+        Int32 input = 4;
+        Int32 position = 0;
+        Int32 emitted = 0;
+
+
+        // Reads the LZ77 data and checks for compressed and uncompressed blocks.
+        // Passes each tile as soon as it is complete and still in the cache.
+        while (position < length)
+        {
+            if (input >= available)
+                return -1;
+
+            UInt8 isDecoded = data[input++];
+            for (int i = 0; i < 8 && position < length; i++)
+            {
+                if ((isDecoded & 0x80) != 0)
                 {
-                    // Can not be encoded; raw data
-                    block.append(raw.at(position++));
+                    if (input + 2 > available)
+                        return -1;
+
+                    int count = ((data[input] >> 4) + 3);
+                    int depos = ((((data[input] & 0xF) << 8) | data[input+1]) + 1);
+                    input += 2;
+                    if (depos > position)
+                        return -1;
+
+                    // Compressed data which needs to be decoded
+                    for (int j = 0; j < count && position < length; j++, position++)
+                        output[position & mask] = output[(position-depos) & mask];
                 }
                 else
                 {
-                    // No data to proceed
+                    if (input >= available)
+                        return -1;
+
+                    // Uncompressed data which needs to be copied
+                    output[(position++) & mask] = data[input++];
+                }
+
+                isDecoded <<= 1;
+            }
+
+            while (position - emitted >= tileSize)
+            {
+                func(output + (emitted & mask), emitted / tileSize);
+                emitted += tileSize;
+            }
+        }
+
+        // Pads the last tile with zeroes, if incomplete
+        if (emitted < length)
+        {
+            QByteArray last(tileSize, 0);
+            std::memcpy(last.data(), output + (emitted & mask), length - emitted);
+            func(reinterpret_cast<const UInt8 *>(last.constData()), emitted / tileSize);
+        }
+
+
+        size[0] = input;
+        if (keep)
+            rom.cache().insert(rom.data(), offset, input, decomp);
+
+        return length;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Lz77::decompressMany(const Rom &rom, const QList<UInt32> &offsets, QVector<Lz77Entry> *entries)
+    {
+        entries->clear();
+        entries->resize(offsets.size());
+
+        // Reads all headers first to lay out the output arena. Entries
+        // that would push the arena beyond LZ77_ARENA_LIMIT are refused.
+        QVector<Int32> order;
+        Int64 total = 0;
+        for (int i = 0; i < offsets.size(); i++)
+        {
+            Lz77Entry &entry = (*entries)[i];
+            UInt32 offset = offsets.at(i);
+            entry.offset = 0;
+            entry.length = 0;
+            entry.size = 0;
+
+            Int32 length = -1;
+            if (rom.checkOffset(offset))
+                length = lz77_length(rom.data() + offset, rom.size() - offset);
+
+            if (length < 0)
+                entry.error = LZ77_ERROR_HEADER;
+            else if (total + length > LZ77_ARENA_LIMIT)
+                entry.error = LZ77_ERROR_ARENA;
+            else
+            {
+                entry.offset = (Int32)total;
+                entry.length = length;
+                total += length;
+                order.push_back(i);
+            }
+        }
+
+        QByteArray arena;
+        arena.resize((Int32)total);
+        UInt8 *output = reinterpret_cast<UInt8 *>(arena.data());
+
+
+        // Decodes the biggest entries first, so that the threads
+        // run out of work at roughly the same time.
+        std::stable_sort(order.begin(), order.end(), [entries](Int32 a, Int32 b)
+        {
+            return entries->at(a).length > entries->at(b).length;
+        });
+
+        QtConcurrent::blockingMap(order, [&rom, &offsets, entries, output](Int32 index)
+        {
+            Lz77Entry &entry = (*entries)[index];
+            UInt32 offset = offsets.at(index);
+
+            // Copies the data from the cache, if decoded before
+            Int32 size = 0;
+            QByteArray cached = rom.cache().find(rom.data(), rom.size(), offset, &size);
+            if (!cached.isNull() && cached.size() == entry.length)
+            {
+                std::memcpy(output + entry.offset, cached.constData(), entry.length);
+                entry.size = size;
+                return;
+            }
+
+            size = lz77_decode(rom.data() + offset, rom.size() - offset, output + entry.offset, entry.length);
+            if (size < 0)
+            {
+                entry.length = 0;
+                entry.error = LZ77_ERROR_DATA;
+            }
+            else
+            {
+                entry.size = size;
+            }
+        });
+
+        return arena;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Encoder definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define LZ77_MIN_LENGTH     3
+    #define LZ77_MAX_LENGTH     18
+    #define LZ77_MIN_DISTANCE   2       // VRAM-safe; never copies the previous byte
+    #define LZ77_MAX_DISTANCE   4096
+    #define LZ77_HASH_SIZE      0x2000
+    #define LZ77_CHAIN_SIZE     0x2000  // power of two, greater than the window
+    #define LZ77_CHAIN_DEPTH    256
+    #define LZ77_SEGMENT_SIZE   0x2000
+
+    ///////////////////////////////////////////////////////////
+    struct Lz77Token
+    {
+        UInt16 length;      // 1 denotes a literal byte
+        UInt16 distance;
+    };
+
+    ///////////////////////////////////////////////////////////
+    struct Lz77Segment
+    {
+        Int32 begin;
+        Int32 end;
+        QVector<Lz77Token> tokens;
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Finds the longest match within the previous 4KB by
+    /// following hash chains of three-byte sequences.
+    ///
+    ///////////////////////////////////////////////////////////
+    class Lz77Matcher {
+    public:
+
+        Lz77Matcher(const UInt8 *data, Int32 size)
+            : m_Data(data),
+              m_Size(size),
+              m_Head(LZ77_HASH_SIZE, -1),
+              m_Chain(LZ77_CHAIN_SIZE, -1)
+        {
+        }
+
+        void insert(Int32 pos)
+        {
+            if (pos + 2 >= m_Size)
+                return;
+
+            UInt32 key = hash(pos);
+            m_Chain[pos & (LZ77_CHAIN_SIZE-1)] = m_Head[key];
+            m_Head[key] = pos;
+        }
+
+        Int32 find(Int32 pos, Int32 end, Int32 *distance) const
+        {
+            Int32 maxLength = qMin(end - pos, LZ77_MAX_LENGTH);
+            if (maxLength < LZ77_MIN_LENGTH)
+                return 0;
+
+            // Walks the chain from the most recent occurrence on;
+            // equally long matches therefore prefer short distances.
+            Int32 best = 0;
+            Int32 candidate = m_Head[hash(pos)];
+            for (int depth = 0; candidate >= 0 && depth < LZ77_CHAIN_DEPTH; depth++)
+            {
+                Int32 dist = pos - candidate;
+                if (dist > LZ77_MAX_DISTANCE)
                     break;
+
+                if (dist >= LZ77_MIN_DISTANCE)
+                {
+                    Int32 length = 0;
+                    while (length < maxLength && m_Data[candidate+length] == m_Data[pos+length])
+                        length++;
+
+                    if (length > best)
+                    {
+                        best = length;
+                        *distance = dist;
+
+                        if (length == maxLength)
+                            break;
+                    }
                 }
+
+                candidate = m_Chain[candidate & (LZ77_CHAIN_SIZE-1)];
             }
 
-            encoded.append(bEnc);
-            encoded.append(block);
+            return (best >= LZ77_MIN_LENGTH) ? best : 0;
         }
 
+    private:
+
+        UInt32 hash(Int32 pos) const
+        {
+            UInt32 bytes = (m_Data[pos] << 16) | (m_Data[pos+1] << 8) | m_Data[pos+2];
+            return (bytes * 2654435761U) >> 19;
+        }
+
+        const UInt8    *m_Data;
+        Int32           m_Size;
+        QVector<Int32>  m_Head;
+        QVector<Int32>  m_Chain;
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Encodes the range [begin, end) of the data. Matches may
+    /// reference up to 4KB before begin, but never cross end;
+    /// the result thus only depends on the range boundaries.
+    /// Stops early and returns false if emit returns false for
+    /// a token.
+    ///
+    ///////////////////////////////////////////////////////////
+    template <typename Emit>
+    bool lz77_encode(const UInt8 *data, Int32 size, Int32 begin, Int32 end, Emit emit)
+    {
+        Lz77Matcher matcher(data, size);
+        for (Int32 pos = qMax(0, begin - LZ77_MAX_DISTANCE); pos < begin; pos++)
+            matcher.insert(pos);
+
+
+        Int32 position = begin;
+        while (position < end)
+        {
+            Int32 distance = 0;
+            Int32 length = matcher.find(position, end, &distance);
+            if (length == 0)
+                length = 1;
+
+            if (!emit(length, distance))
+                return false;
+
+            for (Int32 i = 0; i < length; i++)
+                matcher.insert(position + i);
+
+            position += length;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Packs tokens into blocks of one flag byte followed by
+    /// up to eight literals or two-byte references.
+    ///
+    ///////////////////////////////////////////////////////////
+    class Lz77Packer {
+    public:
+
+        Lz77Packer(const UInt8 *input, UInt8 *output, Int32 inPos, Int32 outPos)
+            : m_Input(input),
+              m_Output(output),
+              m_InPos(inPos),
+              m_OutPos(outPos),
+              m_FlagPos(0),
+              m_Count(8),
+              m_Checkpoints(NULL)
+        {
+        }
+
+        void setCheckpoints(QVector<Lz77Checkpoint> *checkpoints)
+        {
+            m_Checkpoints = checkpoints;
+        }
+
+        bool atBlockStart() const
+        {
+            return m_Count == 8;
+        }
+
+        void put(Int32 length, Int32 distance)
+        {
+            // Starts a new block every eight tokens
+            if (m_Count == 8)
+            {
+                if (m_Checkpoints)
+                    m_Checkpoints->push_back({ m_InPos, m_OutPos });
+
+                m_FlagPos = m_OutPos++;
+                m_Output[m_FlagPos] = 0;
+                m_Count = 0;
+            }
+
+            if (length == 1)
+            {
+                m_Output[m_OutPos++] = m_Input[m_InPos];
+            }
+            else
+            {
+                m_Output[m_FlagPos] |= (UInt8)(0x80 >> m_Count);
+                m_Output[m_OutPos++] = (UInt8)(((length-3) << 4) | ((distance-1) >> 8));
+                m_Output[m_OutPos++] = (UInt8)((distance-1) & 0xFF);
+            }
+
+            m_InPos += length;
+            m_Count++;
+        }
+
+        Int32 input() const
+        {
+            return m_InPos;
+        }
+
+        Int32 output() const
+        {
+            return m_OutPos;
+        }
+
+    private:
+
+        const UInt8                *m_Input;
+        UInt8                      *m_Output;
+        Int32                       m_InPos;
+        Int32                       m_OutPos;
+        Int32                       m_FlagPos;
+        Int32                       m_Count;
+        QVector<Lz77Checkpoint>    *m_Checkpoints;
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Walks over the tokens of previously encoded data.
+    /// Must be started at the beginning of a flag block.
+    ///
+    ///////////////////////////////////////////////////////////
+    class Lz77Reader {
+    public:
+
+        Lz77Reader(const UInt8 *encoded, Int32 inPos, Int32 outPos)
+            : m_Encoded(encoded),
+              m_InPos(inPos),
+              m_OutPos(outPos),
+              m_Flags(0),
+              m_Count(8)
+        {
+        }
+
+        bool atBlockStart() const
+        {
+            return m_Count == 8;
+        }
+
+        void next(Int32 *length, Int32 *distance)
+        {
+            if (m_Count == 8)
+            {
+                m_Flags = m_Encoded[m_OutPos++];
+                m_Count = 0;
+            }
+
+            if ((m_Flags & (0x80 >> m_Count)) != 0)
+            {
+                UInt8 lo = m_Encoded[m_OutPos++];
+                UInt8 hi = m_Encoded[m_OutPos++];
+                *length = (lo >> 4) + 3;
+                *distance = (((lo & 0xF) << 8) | hi) + 1;
+            }
+            else
+            {
+                m_OutPos++;
+                *length = 1;
+                *distance = 0;
+            }
+
+            m_InPos += *length;
+            m_Count++;
+        }
+
+        Int32 input() const
+        {
+            return m_InPos;
+        }
+
+        Int32 output() const
+        {
+            return m_OutPos;
+        }
+
+    private:
+
+        const UInt8    *m_Encoded;
+        Int32           m_InPos;
+        Int32           m_OutPos;
+        UInt8           m_Flags;
+        Int32           m_Count;
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Pads the stream to a multiple of four and finishes the
+    /// checkpoint list with the end of the encoded data.
+    ///
+    ///////////////////////////////////////////////////////////
+    void lz77_finish(QByteArray &encoded, const Lz77Packer &packer, QVector<Lz77Checkpoint> *checkpoints)
+    {
+        if (checkpoints)
+            checkpoints->push_back({ packer.input(), packer.output() });
+
         // Aligns the Lz77 data length to four
-        while (encoded.size() % 4 != 0)
-            encoded.append((char)0);
+        Int32 length = packer.output();
+        UInt8 *output = reinterpret_cast<UInt8 *>(encoded.data());
+        while (length % 4 != 0)
+            output[length++] = 0;
+
+        encoded.resize(length);
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Encodes the whole data and passes the tokens to emit in
+    /// their original order. The data is always encoded in fixed
+    /// segments, so that the tokens are the same no matter how
+    /// many threads are used. Stops early and returns false if
+    /// emit returns false for a token.
+    ///
+    ///////////////////////////////////////////////////////////
+    template <typename Emit>
+    bool lz77_tokens(const UInt8 *data, Int32 size, Boolean parallel, Emit emit)
+    {
+        QVector<Lz77Segment> segments;
+        for (Int32 begin = 0; begin < size; begin += LZ77_SEGMENT_SIZE)
+            segments.push_back({ begin, qMin(begin + LZ77_SEGMENT_SIZE, size), QVector<Lz77Token>() });
+
+        if (parallel && segments.size() > 1)
+        {
+            QtConcurrent::blockingMap(segments, [data, size](Lz77Segment &segment)
+            {
+                QVector<Lz77Token> &tokens = segment.tokens;
+                lz77_encode(data, size, segment.begin, segment.end, [&tokens](Int32 length, Int32 distance)
+                {
+                    tokens.push_back({ (UInt16)length, (UInt16)distance });
+                    return true;
+                });
+            });
+
+            // Stitches the segments together in their original order
+            foreach (const Lz77Segment &segment, segments)
+                foreach (const Lz77Token &token, segment.tokens)
+                    if (!emit(token.length, token.distance))
+                        return false;
+        }
+        else
+        {
+            foreach (const Lz77Segment &segment, segments)
+                if (!lz77_encode(data, size, segment.begin, segment.end, emit))
+                    return false;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray lz77_compress(const QByteArray &raw, Boolean parallel, QVector<Lz77Checkpoint> *checkpoints)
+    {
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        Int32 size = raw.size();
+
+        // Allocates the worst case once and shrinks it afterwards
+        QByteArray encoded;
+        encoded.resize(Lz77::estimateSize(size));
+        UInt8 *output = reinterpret_cast<UInt8 *>(encoded.data());
+
+        // Writes the header and the data length
+        output[0] = 0x10;
+        output[1] = (UInt8)(size & 0xFF);
+        output[2] = (UInt8)((size >> 8) & 0xFF);
+        output[3] = (UInt8)((size >> 16) & 0xFF);
+
+
+        Lz77Packer packer(data, output, 0, 4);
+        packer.setCheckpoints(checkpoints);
+        if (checkpoints)
+            checkpoints->clear();
 
+        lz77_tokens(data, size, parallel, [&packer](Int32 length, Int32 distance)
+        {
+            packer.put(length, distance);
+            return true;
+        });
+
+
+        lz77_finish(encoded, packer, checkpoints);
         return encoded;
     }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Lz77::compress(const QByteArray &raw, QVector<Lz77Checkpoint> *checkpoints)
+    {
+        return lz77_compress(raw, false, checkpoints);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Lz77::compressParallel(const QByteArray &raw, QVector<Lz77Checkpoint> *checkpoints)
+    {
+        return lz77_compress(raw, true, checkpoints);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Lz77::compressInto(Rom &rom, UInt32 offset, const QByteArray &raw, Int32 reserved, Int32 *size)
+    {
+        if (!rom.checkOffset(offset))
+            return false;
+
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        UInt8 *output = rom.data() + offset;
+        Int32 available = rom.size() - offset;
+        Int32 length = raw.size();
+        Int32 base = qMin(reserved, available);
+        Int32 limit = base;
+
+        // Extends the usable space by the free bytes that follow it
+        auto claim = [output, available, &limit](Int32 needed)
+        {
+            while (limit < needed)
+            {
+                if (limit >= available || output[limit] != 0xFF)
+                    return false;
+
+                limit++;
+            }
+
+            return true;
+        };
+
+
+        // Backs up the reserved space only if the data might not fit.
+        // The claimed free space is simply filled again on failure.
+        QByteArray backup;
+        if (estimateSize(length) > base)
+            backup = QByteArray(reinterpret_cast<const char *>(output), base);
+
+        auto restore = [&rom, offset, output, &backup, base, &limit]()
+        {
+            std::memcpy(output, backup.constData(), backup.size());
+            std::memset(output + base, 0xFF, limit - base);
+            rom.cache().invalidate(offset, limit);
+            return false;
+        };
+
+        if (!claim(4))
+            return restore();
+
+        // Writes the header and the data length
+        output[0] = 0x10;
+        output[1] = (UInt8)(length & 0xFF);
+        output[2] = (UInt8)((length >> 8) & 0xFF);
+        output[3] = (UInt8)((length >> 16) & 0xFF);
+
+
+        // Claims the exact space of each token before writing it
+        Lz77Packer packer(data, output, 0, 4);
+        bool fits = lz77_tokens(data, length, length > LZ77_SEGMENT_SIZE, [&packer, &claim](Int32 count, Int32 distance)
+        {
+            Int32 needed = packer.output() + (packer.atBlockStart() ? 1 : 0) + (count == 1 ? 1 : 2);
+            if (!claim(needed))
+                return false;
+
+            packer.put(count, distance);
+            return true;
+        });
+
+        // Aligns the Lz77 data length to four
+        Int32 end = packer.output();
+        if (!fits || !claim((end + 3) & ~3))
+            return restore();
+
+        while (end % 4 != 0)
+            output[end++] = 0;
+
+
+        // Leaves the rom offset behind the data, like every other write
+        rom.cache().invalidate(offset, end);
+        rom.seek(offset + end);
+        size[0] = end;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Lz77::writeInto(Rom &rom, UInt32 offset, const QByteArray &data, Int32 reserved)
+    {
+        if (!rom.checkOffset(offset) || data.size() > static_cast<Int32>(rom.size() - offset))
+            return false;
+
+        // Claims the space before writing; nothing to restore then
+        const UInt8 *output = rom.data() + offset;
+        for (Int32 i = qMax(reserved, 0); i < data.size(); i++)
+        {
+            if (output[i] != 0xFF)
+                return false;
+        }
+
+        rom.seek(offset);
+        rom.writeBytes(data);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Lz77::recompress(
+            const QByteArray &raw,
+            const QByteArray &previous,
+            const QByteArray &encoded,
+            QVector<Lz77Checkpoint> *checkpoints
+    )
+    {
+        // The checkpoints only describe data of the same length
+        Int32 size = raw.size();
+        if (size != previous.size() || checkpoints->size() < 2 || checkpoints->last().input != size)
+            return lz77_compress(raw, true, checkpoints);
+
+
+        // Determines the range of modified bytes
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        const UInt8 *prev = reinterpret_cast<const UInt8 *>(previous.constData());
+        Int32 first = 0;
+        Int32 last = size - 1;
+        while (first < size && data[first] == prev[first])
+            first++;
+        if (first == size)
+            return encoded;
+        while (data[last] == prev[last])
+            last--;
+
+
+        // Tokens may look up to 18 bytes ahead of their position. The
+        // last checkpoint whose preceding tokens could not have seen
+        // the modification is the one to restart the encoder at.
+        const QVector<Lz77Checkpoint> old = *checkpoints;
+        int index = old.size() - 2;
+        while (index > 0 && old.at(index).input + LZ77_MAX_LENGTH > first)
+            index--;
+
+        QByteArray result;
+        result.resize(estimateSize(size));
+        UInt8 *output = reinterpret_cast<UInt8 *>(result.data());
+        std::memcpy(output, encoded.constData(), old.at(index).output);
+
+        checkpoints->resize(index);
+        Lz77Packer packer(data, output, old.at(index).input, old.at(index).output);
+        packer.setCheckpoints(checkpoints);
+
+
+        // Re-encodes until a token starts where an old one did, so far
+        // past the modification that no match could reach back to it.
+        // Every following token is then the same as before.
+        const UInt8 *previousOutput = reinterpret_cast<const UInt8 *>(encoded.constData());
+        Lz77Reader reader(previousOutput, old.at(index).input, old.at(index).output);
+        Boolean replay = false;
+        Int32 begin = old.at(index).input;
+        while (begin < size && !replay)
+        {
+            Int32 end = qMin((begin / LZ77_SEGMENT_SIZE + 1) * LZ77_SEGMENT_SIZE, size);
+            lz77_encode(data, size, begin, end, [&](Int32 length, Int32 distance)
+            {
+                if (packer.input() > last + LZ77_MAX_DISTANCE)
+                {
+                    Int32 skipLength, skipDistance;
+                    while (reader.input() < packer.input())
+                        reader.next(&skipLength, &skipDistance);
+
+                    if (reader.input() == packer.input())
+                    {
+                        replay = true;
+                        return false;
+                    }
+                }
+
+                packer.put(length, distance);
+                return true;
+            });
+
+            begin = end;
+        }
+
+
+        // Replays the old tokens without searching for matches. Once
+        // the flag blocks line up again, the rest is copied as it is.
+        while (replay && reader.input() < size)
+        {
+            if (packer.atBlockStart() && reader.atBlockStart())
+            {
+                int resume = index;
+                while (old.at(resume).input != reader.input())
+                    resume++;
+
+                Int32 shift = packer.output() - reader.output();
+                Int32 tail = old.last().output - reader.output();
+                std::memcpy(output + packer.output(), previousOutput + reader.output(), tail);
+
+                for (int i = resume; i < old.size(); i++)
+                    checkpoints->push_back({ old.at(i).input, old.at(i).output + shift });
+
+                // Aligns the Lz77 data length to four
+                Int32 length = packer.output() + tail;
+                while (length % 4 != 0)
+                    output[length++] = 0;
+
+                result.resize(length);
+                return result;
+            }
+
+            Int32 length, distance;
+            reader.next(&length, &distance);
+            packer.put(length, distance);
+        }
+
+        lz77_finish(result, packer, checkpoints);
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 Lz77::estimateSize(Int32 length)
+    {
+        // Worst case: every byte is a literal, one flag byte per
+        // eight literals, plus the four-byte header.
+        Int32 size = 4 + length + ((length + 7) / 8);
+        return (size + 3) & ~3;
+    }
 }
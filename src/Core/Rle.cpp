@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Rle.hpp>
+#include <cstring>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define RLE_MIN_RUN     3
+    #define RLE_MAX_RUN     130
+    #define RLE_MAX_COPY    128
+
+
+    ///////////////////////////////////////////////////////////
+    QByteArray rle_decode(const UInt8 *data, Int32 available, Int32 *size)
+    {
+        if (available < 4 || data[0] != 0x30)
+            return QByteArray(NULL);
+
+        // Retrieves the length of the RLE data
+        Int32 length = data[1] | (data[2] << 8) | (data[3] << 16);
+        Int32 input = 4;
+        Int32 position = 0;
+
+        QByteArray decomp;
+        decomp.resize(length);
+        UInt8 *output = reinterpret_cast<UInt8 *>(decomp.data());
+
+
+        // Bit 7 of each flag byte determines whether a run or a
+        // sequence of uncompressed bytes follows.
+        while (position < length)
+        {
+            if (input >= available)
+                return QByteArray(NULL);
+
+            UInt8 flag = data[input++];
+            if ((flag & 0x80) != 0)
+            {
+                if (input >= available)
+                    return QByteArray(NULL);
+
+                Int32 count = qMin((flag & 0x7F) + RLE_MIN_RUN, length - position);
+                std::memset(output + position, data[input++], count);
+                position += count;
+            }
+            else
+            {
+                Int32 count = qMin((flag & 0x7F) + 1, length - position);
+                if (input + count > available)
+                    return QByteArray(NULL);
+
+                std::memcpy(output + position, data + input, count);
+                position += count;
+                input += count;
+            }
+        }
+
+
+        size[0] = input;
+        return decomp;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Rle::decompress(const Rom &rom, UInt32 offset, Int32 *size)
+    {
+        if (!rom.checkOffset(offset))
+            return QByteArray(NULL);
+
+        return rle_decode(rom.data() + offset, rom.size() - offset, size);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Rle::decompress(const QByteArray &data, Int32 *size)
+    {
+        return rle_decode(reinterpret_cast<const UInt8 *>(data.constData()), data.size(), size);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Rle::compress(const QByteArray &raw)
+    {
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(raw.constData());
+        Int32 size = raw.size();
+
+        // Writes the header and the data length
+        QByteArray encoded;
+        encoded.reserve(4 + size + (size / RLE_MAX_COPY) + 4);
+        encoded.append((char)0x30);
+        encoded.append((char)(size & 0xFF));
+        encoded.append((char)((size >> 8) & 0xFF));
+        encoded.append((char)((size >> 16) & 0xFF));
+
+
+        // Collects uncompressed bytes until a run is long enough
+        Int32 position = 0;
+        Int32 pending = 0;
+        while (position < size)
+        {
+            Int32 run = 1;
+            while (position + run < size && run < RLE_MAX_RUN && data[position+run] == data[position])
+                run++;
+
+            if (run >= RLE_MIN_RUN)
+            {
+                position += run;
+                encoded.append((char)(0x80 | (run - RLE_MIN_RUN)));
+                encoded.append((char)data[position-1]);
+                continue;
+            }
+
+            // Flushes the uncompressed bytes before the next run or
+            // as soon as the maximum amount is reached.
+            position += run;
+            pending += run;
+            while (pending >= RLE_MAX_COPY || (pending > 0 && position >= size))
+            {
+                Int32 count = qMin(pending, RLE_MAX_COPY);
+                encoded.append((char)(count - 1));
+                encoded.append(reinterpret_cast<const char *>(data + position - pending), count);
+                pending -= count;
+            }
+
+            if (pending > 0 && position + RLE_MIN_RUN <= size &&
+                data[position] == data[position+1] && data[position] == data[position+2])
+            {
+                encoded.append((char)(pending - 1));
+                encoded.append(reinterpret_cast<const char *>(data + position - pending), pending);
+                pending = 0;
+            }
+        }
+
+
+        // Aligns the RLE data length to four
+        while (encoded.size() % 4 != 0)
+            encoded.append((char)0);
+
+        return encoded;
+    }
+}
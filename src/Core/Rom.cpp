@@ -98,6 +98,7 @@ namespace qboy
         }
 
         // Copies necessary values into the class members
+        m_Cache.clear();
         m_Length = static_cast<UInt32>(m_Reference.size());
         m_Array  = reinterpret_cast<UInt8*>(m_Reference.data());
 
@@ -121,6 +122,7 @@ namespace qboy
     {
         // Resets the rom array
         m_Reference.clear();
+        m_Cache.clear();
 
         // Resets the necessary I/O information
         m_Info.setValid(false);
@@ -183,12 +185,24 @@ namespace qboy
         return m_Array;
     }
 
+    ///////////////////////////////////////////////////////////
+    UInt32 Rom::size() const
+    {
+        return m_Length;
+    }
+
     ///////////////////////////////////////////////////////////
     const RomInfo &Rom::info() const
     {
         return m_Info;
     }
 
+    ///////////////////////////////////////////////////////////
+    RomCache &Rom::cache() const
+    {
+        return m_Cache;
+    }
+
 
     ///////////////////////////////////////////////////////////
     bool Rom::checkCurrentOffset() const
@@ -335,6 +349,7 @@ namespace qboy
     void Rom::writeByte(UInt8 byte)
     {
         Q_ASSERT(canWrite(VT_Byte));
+        m_Cache.invalidate(m_Offset, VT_Byte);
         m_Array[m_Offset++] = byte;
     }
 
@@ -342,6 +357,7 @@ namespace qboy
     void Rom::writeHWord(UInt16 hword)
     {
         Q_ASSERT(canWrite(VT_HWord));
+        m_Cache.invalidate(m_Offset, VT_HWord);
         m_Array[m_Offset++] = (UInt8)(hword & 0xFF);
         m_Array[m_Offset++] = (UInt8)(hword >> 0x8);
     }
@@ -350,6 +366,7 @@ namespace qboy
     void Rom::writeWord(UInt32 word)
     {
         Q_ASSERT(canWrite(VT_Word));
+        m_Cache.invalidate(m_Offset, VT_Word);
         m_Array[m_Offset++] = (UInt8)(word & 0xFF);
         m_Array[m_Offset++] = (UInt8)(word >> 0x08);
         m_Array[m_Offset++] = (UInt8)(word >> 0x10);
@@ -370,7 +387,8 @@ namespace qboy
     void Rom::writeBytes(const QByteArray &bytes)
     {
         Q_ASSERT(canWrite(bytes.size()));
-        std::copy(bytes.data(), bytes.data() + bytes.size(), m_Array);
+        m_Cache.invalidate(m_Offset, bytes.size());
+        std::copy(bytes.data(), bytes.data() + bytes.size(), m_Array + m_Offset);
         m_Offset += bytes.size();
     }
 
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/RomCache.hpp>
+#include <QList>
+#include <QMutexLocker>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Cache definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define ROMCACHE_BUDGET     (16 * 1024 * 1024)
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    RomCache::RomCache()
+        : m_Entries(ROMCACHE_BUDGET),
+          m_Longest(0),
+          m_Lower(0),
+          m_Upper(0)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QByteArray RomCache::find(const UInt8 *rom, UInt32 length, UInt32 offset, Int32 *size)
+    {
+        QMutexLocker lock(&m_Mutex);
+        RomCacheEntry *entry = m_Entries.object(offset);
+        if (entry == NULL)
+            return QByteArray(NULL);
+
+        // Drops the entry if the encoded data was changed without
+        // going through the write functions of qboy::Rom.
+        if (offset + entry->size > length ||
+            qHashBits(rom + offset, entry->size) != entry->hash)
+        {
+            m_Entries.remove(offset);
+            m_Ranges.remove(offset);
+            return QByteArray(NULL);
+        }
+
+        size[0] = entry->size;
+        return entry->data;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void RomCache::insert(const UInt8 *rom, UInt32 offset, Int32 size, const QByteArray &data)
+    {
+        QMutexLocker lock(&m_Mutex);
+        if (data.size() > m_Entries.maxCost())
+            return;
+
+        RomCacheEntry *entry = new RomCacheEntry;
+        entry->size = size;
+        entry->hash = qHashBits(rom + offset, size);
+        entry->data = data;
+        m_Entries.insert(offset, entry, qMax(data.size(), 1));
+
+        // Evicted entries are not reported by QCache; their ranges
+        // are removed once they clearly outnumber the live ones.
+        if (m_Ranges.size() > m_Entries.size() * 2 + 64)
+        {
+            QList<UInt32> keys = m_Entries.keys();
+            QMap<UInt32, Int32> ranges;
+            for (int i = 0; i < keys.size(); i++)
+                ranges.insert(keys.at(i), m_Ranges.value(keys.at(i)));
+
+            m_Ranges = ranges;
+        }
+
+        // Widens the range in which writes need to be checked
+        m_Ranges.insert(offset, size);
+        m_Longest = qMax(m_Longest, size);
+        if (m_Upper.load() == 0)
+            m_Lower.storeRelease(offset);
+        else
+            m_Lower.storeRelease(qMin((UInt32)m_Lower.load(), offset));
+
+        m_Upper.storeRelease(qMax((UInt32)m_Upper.load(), offset + size));
+    }
+
+    ///////////////////////////////////////////////////////////
+    void RomCache::invalidate(UInt32 offset, Int32 count)
+    {
+        if (offset >= (UInt32)m_Upper.loadAcquire() || offset + count <= (UInt32)m_Lower.loadAcquire())
+            return;
+
+        // Visits every entry that may start before the end of the
+        // range and still reach into it.
+        QMutexLocker lock(&m_Mutex);
+        UInt32 first = (offset > (UInt32)m_Longest) ? offset - m_Longest : 0;
+        QMap<UInt32, Int32>::iterator it = m_Ranges.lowerBound(first);
+        while (it != m_Ranges.end() && it.key() < offset + count)
+        {
+            if (it.key() + it.value() > offset)
+            {
+                m_Entries.remove(it.key());
+                it = m_Ranges.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (m_Entries.isEmpty())
+        {
+            m_Ranges.clear();
+            m_Longest = 0;
+            m_Lower.storeRelease(0);
+            m_Upper.storeRelease(0);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    void RomCache::clear()
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_Entries.clear();
+        m_Ranges.clear();
+        m_Longest = 0;
+        m_Lower.storeRelease(0);
+        m_Upper.storeRelease(0);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    Int32 RomCache::budget() const
+    {
+        QMutexLocker lock(&m_Mutex);
+        return m_Entries.maxCost();
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 RomCache::usage() const
+    {
+        QMutexLocker lock(&m_Mutex);
+        return m_Entries.totalCost();
+    }
+
+    ///////////////////////////////////////////////////////////
+    void RomCache::setBudget(Int32 bytes)
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_Entries.setMaxCost(bytes);
+    }
+}
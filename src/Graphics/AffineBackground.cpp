@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Lz77.hpp>
+#include <QBoy/Graphics/AffineBackground.hpp>
+#include <QBoy/Graphics/TilemapErrors.hpp>
+#include <cstring>
+#include "Parallel.hpp"
+#ifdef QBOY_AVX2
+    #include <immintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Affine definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define AFFINE_PADDING          4   // gathers read 32-bit words
+
+
+    ///////////////////////////////////////////////////////////
+    /// Renders one scanline, stepping through the map by the
+    /// per-pixel increments from the given start position.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void affine_line(
+            const UInt8 *bitmap,
+            Int32 shift,
+            Boolean wrap,
+            Int32 x,
+            Int32 y,
+            Int32 dx,
+            Int32 dy,
+            Int32 width,
+            UInt8 *output)
+    {
+        Int32 size = 1 << shift;
+        Int32 mask = size - 1;
+        Int32 i = 0;
+
+    #ifdef QBOY_AVX2
+        const __m256i steps = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i vmask = _mm256_set1_epi32(mask);
+        const __m256i vsize = _mm256_set1_epi32(size);
+        const __m256i bytes = _mm256_set1_epi32(0xFF);
+        const __m256i none = _mm256_set1_epi32(-1);
+        __m256i vx = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_mullo_epi32(steps, _mm256_set1_epi32(dx)));
+        __m256i vy = _mm256_add_epi32(_mm256_set1_epi32(y), _mm256_mullo_epi32(steps, _mm256_set1_epi32(dy)));
+        __m256i stepX = _mm256_set1_epi32(dx * 8);
+        __m256i stepY = _mm256_set1_epi32(dy * 8);
+
+        for (; i + 8 <= width; i += 8)
+        {
+            __m256i px = _mm256_srai_epi32(vx, 8);
+            __m256i py = _mm256_srai_epi32(vy, 8);
+            __m256i inside = none;
+
+            if (wrap)
+            {
+                px = _mm256_and_si256(px, vmask);
+                py = _mm256_and_si256(py, vmask);
+            }
+            else
+            {
+                // Positions outside of the map read the first byte
+                inside = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_cmpgt_epi32(px, none), _mm256_cmpgt_epi32(vsize, px)),
+                    _mm256_and_si256(_mm256_cmpgt_epi32(py, none), _mm256_cmpgt_epi32(vsize, py)));
+            }
+
+            __m256i address = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(py, shift), px), inside);
+            __m256i pixels = _mm256_i32gather_epi32(reinterpret_cast<const int *>(bitmap), address, 1);
+            pixels = _mm256_and_si256(_mm256_and_si256(pixels, bytes), inside);
+
+            __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(pixels), _mm256_extracti128_si256(pixels, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + i), _mm_packus_epi16(words, words));
+
+            vx = _mm256_add_epi32(vx, stepX);
+            vy = _mm256_add_epi32(vy, stepY);
+        }
+
+        x += dx * i;
+        y += dy * i;
+    #endif
+
+        for (; i < width; i++, x += dx, y += dy)
+        {
+            Int32 px = x >> 8;
+            Int32 py = y >> 8;
+
+            if (wrap)
+                output[i] = bitmap[((py & mask) << shift) + (px & mask)];
+            else if (static_cast<UInt32>(px) < static_cast<UInt32>(size) && static_cast<UInt32>(py) < static_cast<UInt32>(size))
+                output[i] = bitmap[(py << shift) + px];
+            else
+                output[i] = 0;
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    AffineBackground::AffineBackground()
+        : m_Size(0),
+          m_TileCount(0),
+          m_Pa(0x100),
+          m_Pb(0),
+          m_Pc(0),
+          m_Pd(0x100),
+          m_X(0),
+          m_Y(0),
+          m_Wrap(false)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &AffineBackground::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool AffineBackground::readUncompressed(const Rom &rom, UInt32 offset, Int32 size)
+    {
+        // Attempts to seek to the given offset
+        if (!rom.seek(offset) || !rom.canRead(size * size))
+        {
+            m_LastError = MAP_ERROR_OFFSET;
+            return false;
+        }
+
+        return setEntries(rom.readBytes(size * size));
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool AffineBackground::readCompressed(const Rom &rom, UInt32 offset)
+    {
+        // Determines whether the given offset is valid
+        if (!rom.checkOffset(offset))
+        {
+            m_LastError = MAP_ERROR_OFFSET;
+            return false;
+        }
+
+        // Attempts to decompress the LZ77 data
+        Int32 size = 0;
+        QByteArray data = Lz77::decompress(rom, offset, &size);
+        if (data.isNull())
+        {
+            m_LastError = MAP_ERROR_LZ77;
+            return false;
+        }
+
+        return setEntries(data);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool AffineBackground::setEntries(const QByteArray &entries)
+    {
+        Int32 size = 16;
+        while (size < 128 && size * size < entries.size())
+            size *= 2;
+
+        if (size * size != entries.size())
+        {
+            m_LastError = MAP_ERROR_AFFINE;
+            return false;
+        }
+
+        m_Entries = entries;
+        m_Size = size;
+        compose();
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void AffineBackground::setTiles(const Image &tiles)
+    {
+        Int32 columns = tiles.size().width() / 8;
+        Int32 rows = tiles.size().height() / 8;
+
+        // Gathers 64 indices per tile, row by row
+        m_TileCount = columns * rows;
+        m_Tiles.resize(m_TileCount * 64);
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Tiles.data());
+
+        for (Int32 tile = 0; tile < m_TileCount; tile++)
+            for (int y = 0; y < 8; y++)
+                for (int x = 0; x < 8; x++)
+                    *output++ = tiles.pixel((tile % columns) * 8 + x, (tile / columns) * 8 + y);
+
+        compose();
+    }
+
+    ///////////////////////////////////////////////////////////
+    void AffineBackground::compose()
+    {
+        Int32 pixels = m_Size * 8;
+        m_Bitmap = QByteArray(pixels * pixels + AFFINE_PADDING, '\0');
+
+        const UInt8 *entries = reinterpret_cast<const UInt8 *>(m_Entries.constData());
+        const UInt8 *tiles = reinterpret_cast<const UInt8 *>(m_Tiles.constData());
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Bitmap.data());
+
+        for (Int32 i = 0; i < m_Size * m_Size; i++)
+        {
+            if (entries[i] >= m_TileCount)
+                continue;
+
+            const UInt8 *tile = tiles + entries[i] * 64;
+            UInt8 *target = output + (i / m_Size) * 8 * pixels + (i % m_Size) * 8;
+            for (int y = 0; y < 8; y++)
+                std::memcpy(target + y * pixels, tile + y * 8, 8);
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void AffineBackground::setTransform(Int16 pa, Int16 pb, Int16 pc, Int16 pd, Int32 x, Int32 y)
+    {
+        m_Pa = pa;
+        m_Pb = pb;
+        m_Pc = pc;
+        m_Pd = pd;
+        m_X = x;
+        m_Y = y;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void AffineBackground::setWrap(Boolean wrap)
+    {
+        m_Wrap = wrap;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    Int32 AffineBackground::size() const
+    {
+        return m_Size;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray AffineBackground::renderIndexed(Int32 width, Int32 height) const
+    {
+        QByteArray output(width * height, '\0');
+        if (m_Size == 0)
+            return output;
+
+        // The map is 2^shift pixels in size
+        Int32 shift = 7;
+        while ((1 << shift) < m_Size * 8)
+            shift++;
+
+        const UInt8 *bitmap = reinterpret_cast<const UInt8 *>(m_Bitmap.constData());
+        UInt8 *pixels = reinterpret_cast<UInt8 *>(output.data());
+        Int32 x = m_X, y = m_Y, pa = m_Pa, pb = m_Pb, pc = m_Pc, pd = m_Pd;
+        Boolean wrap = m_Wrap;
+
+        // Each scanline starts one step of (PB, PD) further
+        parallel_bands(height, PARALLEL_BAND_LINES, [=](Int32 first, Int32 last)
+        {
+            for (Int32 line = first; line < last; line++)
+                affine_line(bitmap, shift, wrap, x + pb * line, y + pd * line, pa, pc, width, pixels + line * width);
+        });
+
+        return output;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QVector<Color> AffineBackground::render(const Palette &palette, Int32 width, Int32 height) const
+    {
+        Color lookup[256];
+        std::memset(lookup, 0, sizeof(lookup));
+
+        const QVector<Color> &colors = palette.raw();
+        for (int i = 1; i < colors.size() && i < 256; i++)
+            lookup[i] = colors.at(i);
+
+
+        QByteArray indices = renderIndexed(width, height);
+        QVector<Color> output(width * height);
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(indices.constData());
+        Color *target = output.data();
+
+        for (int i = 0; i < indices.size(); i++)
+            target[i] = lookup[input[i]];
+
+        return output;
+    }
+}
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/ColorCodec.hpp>
+#ifdef QBOY_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// Expands eight GBA colors to eight RGBA colors.
+    ///
+    ///////////////////////////////////////////////////////////
+    #ifdef QBOY_SSE2
+    inline void color_decode8(__m128i colors, Color *output)
+    {
+        const __m128i five = _mm_set1_epi16(0x1F);
+        const __m128i alpha = _mm_set1_epi16(static_cast<Int16>(0xFF00));
+
+        __m128i r = _mm_and_si128(colors, five);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(colors, 5), five);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(colors, 10), five);
+
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+        // Lanes of red/green and blue/alpha form RGBA pixels
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 0), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Reduces eight RGBA colors to eight GBA colors.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline __m128i color_encode8(const Color *input)
+    {
+        const __m128i red = _mm_set1_epi32(0x001F);
+        const __m128i green = _mm_set1_epi32(0x03E0);
+        const __m128i blue = _mm_set1_epi32(0x7C00);
+        __m128i halves[2];
+
+        for (int i = 0; i < 2; i++)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i * 4));
+            halves[i] = _mm_or_si128(_mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(v, 3), red),
+                _mm_and_si128(_mm_srli_epi32(v, 6), green)),
+                _mm_and_si128(_mm_srli_epi32(v, 9), blue));
+        }
+
+        // Values stay below 0x8000, thus signed packing is exact
+        return _mm_packs_epi32(halves[0], halves[1]);
+    }
+    #endif
+
+    ///////////////////////////////////////////////////////////
+    /// Expands one GBA color to an RGBA color.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline Color color_decode(UInt16 color)
+    {
+        UInt8 r = color & 0x1F;
+        UInt8 g = (color >> 5) & 0x1F;
+        UInt8 b = (color >> 10) & 0x1F;
+
+        Color result = {
+            static_cast<UInt8>((r << 3) | (r >> 2)),
+            static_cast<UInt8>((g << 3) | (g >> 2)),
+            static_cast<UInt8>((b << 3) | (b >> 2)),
+            255
+        };
+
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Reduces one RGBA color to a GBA color.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline UInt16 color_encode(const Color &color)
+    {
+        return static_cast<UInt16>((color.r >> 3) | ((color.g >> 3) << 5) | ((color.b >> 3) << 10));
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void ColorCodec::decode(const UInt16 *input, Int32 count, Color *output)
+    {
+        Int32 i = 0;
+
+    #ifdef QBOY_SSE2
+        for (; i + 8 <= count; i += 8)
+            color_decode8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)), output + i);
+    #endif
+
+        for (; i < count; i++)
+            output[i] = color_decode(input[i]);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void ColorCodec::decodeBytes(const UInt8 *input, Int32 count, Color *output)
+    {
+        Int32 i = 0;
+
+    #ifdef QBOY_SSE2
+        // SSE2 implies a little-endian machine
+        for (; i + 8 <= count; i += 8)
+            color_decode8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i * 2)), output + i);
+    #endif
+
+        for (; i < count; i++)
+            output[i] = color_decode(static_cast<UInt16>(input[i*2] | (input[i*2+1] << 8)));
+    }
+
+    ///////////////////////////////////////////////////////////
+    void ColorCodec::encode(const Color *input, Int32 count, UInt16 *output)
+    {
+        Int32 i = 0;
+
+    #ifdef QBOY_SSE2
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), color_encode8(input + i));
+    #endif
+
+        for (; i < count; i++)
+            output[i] = color_encode(input[i]);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void ColorCodec::encodeBytes(const Color *input, Int32 count, UInt8 *output)
+    {
+        Int32 i = 0;
+
+    #ifdef QBOY_SSE2
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 2), color_encode8(input + i));
+    #endif
+
+        for (; i < count; i++)
+        {
+            UInt16 color = color_encode(input[i]);
+            output[i*2+0] = static_cast<UInt8>(color & 0xFF);
+            output[i*2+1] = static_cast<UInt8>(color >> 8);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    void ColorCodec::toGL(const Color *input, Int32 count, GLColor *output)
+    {
+        Int32 i = 0;
+
+    #ifdef QBOY_SSE2
+        // One color fills one vector of four floats
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+            float *target = reinterpret_cast<float *>(output + i);
+            _mm_storeu_ps(target + 0,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+            _mm_storeu_ps(target + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+            _mm_storeu_ps(target + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+            _mm_storeu_ps(target + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+        }
+    #endif
+
+        for (; i < count; i++)
+        {
+            output[i].r = input[i].r * (1.0f / 255.0f);
+            output[i].g = input[i].g * (1.0f / 255.0f);
+            output[i].b = input[i].b * (1.0f / 255.0f);
+            output[i].a = input[i].a * (1.0f / 255.0f);
+        }
+    }
+}
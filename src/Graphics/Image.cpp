@@ -27,10 +27,18 @@
 #include <QBoy/Core/Lz77.hpp>
 #include <QBoy/Graphics/Image.hpp>
 #include <QBoy/Graphics/ImageErrors.hpp>
-#include <cmath>
+#include <QBoy/Graphics/TileCodec.hpp>
+#include <cstring>
 
 namespace qboy
 {
+    ///////////////////////////////////////////////////////////
+    // Definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define IMG_NO_OFFSET       0xFFFFFFFF
+
+
     ///////////////////////////////////////////////////////////
     // Constructor and destructor
     //
@@ -38,9 +46,11 @@ namespace qboy
     Image::Image()
         : m_Palette(0),
           m_DataSize(0),
+          m_Offset(IMG_NO_OFFSET),
           m_Width(0),
           m_Height(0),
-          m_Is4Bpp(false)
+          m_Is4Bpp(false),
+          m_IsPacked(false)
     {
     }
 
@@ -50,6 +60,11 @@ namespace qboy
         m_Data = img.m_Data;
         m_Palette = img.m_Palette;
         m_DataSize = img.m_DataSize;
+        m_Offset = img.m_Offset;
+        m_Width = img.m_Width;
+        m_Height = img.m_Height;
+        m_Is4Bpp = img.m_Is4Bpp;
+        m_IsPacked = img.m_IsPacked;
     }
 
 
@@ -77,52 +92,20 @@ namespace qboy
             return false;
         }
 
-
-        // If the data is 4bpp, it needs to be widened for the OpenGL
-        // shader and for faster pixel access in general.
-        if (is4bpp)
+        // Reads the uncompressed data and assures it is valid
+        QByteArray data = rom.readBytes(length);
+        if (width <= 0 || width % 8 != 0 || length % 2 != 0 || data.isNull())
         {
-            // Reads the uncompressed data and assures it is valid
-            QByteArray data = rom.readBytes(length);
-            if (width % 8 != 0 || length % 2 != 0 || data.isNull())
-            {
-                m_LastError = IMG_ERROR_LENGTH;
-                return false;
-            }
-
-            // Calculates the height, given by width and data length
-            float ratio = (float)((length / 32.0f) / (width / 8.0f));
-            m_Height = (int)(ceilf(ratio))*8;
-            m_Width = width;
-            m_DataSize = length;
-            m_Data.resize(m_Width*m_Height);
-
-            // Converts the 4bpp data to 8bpp data. Extracts the two nibbles out
-            // of one byte in each iteration and treats them as indices.
-            int pixelInc = 0;
-            for (int y = 0; y < m_Height-7; y+=8)
-                for (int x = 0; x < width-7; x+=8)
-                    for (int y2 = 0; y2 < 8; y2++)
-                        for (int x2 = 0; x2 < 8; x2+=2)
-                        {
-                            UInt8 nibbles = data.at(pixelInc++);
-                            m_Data[(x+x2+1)+((y+y2)*width)] = (Int8)((nibbles & 0xF0) >> 4);
-                            m_Data[(x+x2+0)+((y+y2)*width)] = (Int8)((nibbles & 0x0F));
-                        }
-        }
-        else
-        {
-            // Reads the uncompressed data and assures it is valid
-            m_Data = rom.readBytes(length);
-            if (width % 8 != 0 || length % 2 != 0 || m_Data.isNull())
-            {
-                m_LastError = IMG_ERROR_LENGTH;
-                return false;
-            }
+            m_LastError = IMG_ERROR_LENGTH;
+            return false;
         }
 
 
-        m_Is4Bpp = is4bpp;
+        // De-tiles the data for the OpenGL shader and for
+        // faster pixel access in general.
+        m_DataSize = length;
+        m_Offset = offset;
+        convertFromGBA(data, width, is4bpp);
         return true;
     }
 
@@ -131,7 +114,8 @@ namespace qboy
             const Rom &rom,
             UInt32 offset,
             Int32 width,
-            Boolean is4bpp
+            Boolean is4bpp,
+            Boolean cache
     )
     {
         if (!rom.seek(offset))
@@ -140,68 +124,53 @@ namespace qboy
             return false;
         }
 
-
-        // If the data is 4bpp, it needs to be widened for the OpenGL
-        // shader and for faster pixel access in general.
-        if (is4bpp)
+        // Reads the uncompressed size and assures it is valid
+        Int32 length = Lz77::decompressedSize(rom, offset);
+        if (length < 0)
         {
-            // Decompresses the LZ77 data and assures it is valid
-            QByteArray data = Lz77::decompress(rom, offset, &m_DataSize);
-            if (width % 8 != 0 || data.size() % 2 != 0)
-            {
-                m_LastError = IMG_ERROR_LENGTH;
-                return false;
-            }
-            else if (data.isNull())
-            {
-                m_LastError = IMG_ERROR_LZ77;
-                return false;
-            }
-
-            // Calculates the height, given by width and data length
-            float ratio = (float)((data.size() / 32.0f) / (width / 8.0f));
-            m_Height = (int)(ceilf(ratio))*8;
-            m_Width = width;
-            m_Data.resize(m_Width*m_Height);
-
-            // Converts the 4bpp data to 8bpp data. Extracts the two nibbles out
-            // of one byte in each iteration and treats them as indices.
-            int pixelInc = 0;
-            for (int y = 0; y < m_Height-7; y+=8)
-                for (int x = 0; x < width-7; x+=8)
-                    for (int y2 = 0; y2 < 8; y2++)
-                        for (int x2 = 0; x2 < 8; x2+=2)
-                        {
-                            if (pixelInc == data.size())
-                                goto end;
-
-                            UInt8 nibbles = data.at(pixelInc++);
-                            m_Data[(x+x2+1)+((y+y2)*width)] = (Int8)((nibbles & 0xF0) >> 4);
-                            m_Data[(x+x2+0)+((y+y2)*width)] = (Int8)((nibbles & 0x0F));
-                        }
+            m_LastError = IMG_ERROR_LZ77;
+            return false;
         }
-        else
+        else if (width <= 0 || width % 8 != 0 || length % 2 != 0)
         {
-            m_Data = Lz77::decompress(rom, offset, &m_DataSize);
-            if (width % 8 != 0 || m_Data.size() % 2 != 0)
-            {
-                m_LastError = IMG_ERROR_LENGTH;
-                return false;
-            }
-            else if (m_Data.isNull())
-            {
-                m_LastError = IMG_ERROR_LZ77;
-                return false;
-            }
+            m_LastError = IMG_ERROR_LENGTH;
+            return false;
+        }
+
 
-            // Calculates the height, given by width and data length
-            float ratio = (float)((m_Data.size() / 32.0f) / (width / 8.0f));
-            m_Height = (int)(ceilf(ratio))*8;
-            m_Width = width;
+        // De-tiles every tile right after it was decompressed, which
+        // avoids passing over the whole decompressed data again.
+        allocate(length, width, is4bpp);
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Data.data());
+        Int32 columns = m_Width / 8;
+        Int32 stride = m_IsPacked ? m_Width / 2 : m_Width;
+        Int32 tileWidth = m_IsPacked ? 4 : 8;
+        Boolean isPacked = m_IsPacked;
+        Int32 decoded = Lz77::decompressTiles(rom, offset, is4bpp ? 32 : 64, [=](const UInt8 *tile, Int32 index)
+        {
+            UInt8 *target = output + (index / columns) * 8 * stride + (index % columns) * tileWidth;
+            if (isPacked)
+                TileCodec::decodeTile4bppPacked(tile, target, stride);
+            else if (is4bpp)
+                TileCodec::decodeTile4bpp(tile, target, stride);
+            else
+                TileCodec::decodeTile8bpp(tile, target, stride);
+        }, &m_DataSize, cache);
+
+        if (decoded < 0)
+        {
+            m_LastError = IMG_ERROR_LZ77;
+            return false;
         }
 
-    end:
-        m_Is4Bpp = is4bpp;
+        m_Offset = offset;
+
+        // Clears the tiles in the last row that are not covered
+        Int32 tiles = (length + (is4bpp ? 31 : 63)) / (is4bpp ? 32 : 64);
+        for (Int32 index = tiles; index < columns * (m_Height / 8); index++)
+            for (int y = 0; y < 8; y++)
+                std::memset(output + ((index / columns) * 8 + y) * stride + (index % columns) * tileWidth, 0, tileWidth);
+
         return true;
     }
 
@@ -211,14 +180,26 @@ namespace qboy
         IndexedTexture *tex = new IndexedTexture;
         tex->setOpenGLFunctions(funcs);
         tex->setParentWidget(parent);
-        tex->setImage((UInt8*)m_Data.data(), m_Width, m_Height);
-        tex->setPalette((GLColor*)m_Palette->rawGL().data());
+        tex->setImage((UInt8*)m_Data.data(), m_Width, m_Height, m_IsPacked);
+        tex->setPalette(m_Palette->rawGL().constData(), m_Palette->rawGL().size());
 
 
         // Returns the texture; widget and functions must be specified manually
         return tex;
     }
 
+    ///////////////////////////////////////////////////////////
+    const IndexedTexture *Image::texture(QOpenGLFunctions *funcs, QOpenGLWidget *parent, PaletteBank *bank, Int32 offset) const
+    {
+        IndexedTexture *tex = new IndexedTexture;
+        tex->setOpenGLFunctions(funcs);
+        tex->setParentWidget(parent);
+        tex->setImage((UInt8*)m_Data.data(), m_Width, m_Height, m_IsPacked);
+        tex->setPalette(bank, offset);
+
+        return tex;
+    }
+
 
     ///////////////////////////////////////////////////////////
     bool Image::requiresRepoint(bool isCompressed)
@@ -226,11 +207,12 @@ namespace qboy
         // Converts the image to GBA index data first
         convertToGBA();
 
-        // Retrieves the new size of the image
+        // Retrieves the new size of the image. If even the worst
+        // case fits, there is no need to compress the data at all.
         int newSize = 0;
-        if (isCompressed)
-            newSize = Lz77::compress(m_Buffer).size();
-        else
+        if (isCompressed && Lz77::estimateSize(m_Buffer.size()) > m_DataSize)
+            newSize = compressed().size();
+        else if (!isCompressed)
             newSize = m_Buffer.size();
 
 
@@ -244,26 +226,49 @@ namespace qboy
         if (m_Buffer.isNull() || m_Buffer.isEmpty())
             convertToGBA();
 
-        // Compresses the buffer, if requested
-        if (isLz77)
+        if (!rom.seek(offset))
+        {
+            m_LastError = IMG_ERROR_OFFSET;
+            return false;
+        }
+
+        // The old data may only be overwritten where it was read from
+        Int32 reserved = (offset == m_Offset) ? m_DataSize : 0;
+
+        // Streams the compressed data directly into the rom, unless
+        // it was already compressed for this exact data before.
+        if (isLz77 && (m_Encoded.isEmpty() || m_EncodedKey != m_Buffer))
         {
-            m_Buffer = Lz77::compress(m_Buffer);
+            Int32 size = 0;
+            if (!Lz77::compressInto(rom, offset, m_Buffer, reserved, &size))
+            {
+                m_LastError = IMG_ERROR_SPACE;
+                return false;
+            }
 
-            if (m_Buffer.isNull() || m_Buffer.isEmpty())
+            m_DataSize = size;
+        }
+        else if (isLz77)
+        {
+            if (!Lz77::writeInto(rom, offset, m_Encoded, reserved))
             {
-                m_LastError = IMG_ERROR_LZ77;
+                m_LastError = IMG_ERROR_SPACE;
                 return false;
             }
+
+            m_DataSize = m_Encoded.size();
         }
-        if (!rom.seek(offset))
+        else
         {
-            m_LastError = IMG_ERROR_OFFSET;
-            return false;
+            // Writes the image to ROM
+            rom.writeBytes(m_Buffer);
+            m_DataSize = m_Buffer.size();
         }
 
+        m_Offset = offset;
+
 
-        // Writes the image to ROM and clears the buffer
-        rom.writeBytes(m_Buffer);
+        // Clears the buffer
         m_Buffer.clear();
 
         return true;
@@ -273,25 +278,88 @@ namespace qboy
     ///////////////////////////////////////////////////////////
     // Protected methods
     //
+    ///////////////////////////////////////////////////////////
+    void Image::allocate(Int32 length, Int32 width, Boolean is4bpp)
+    {
+        // Calculates the height, given by width and data length
+        Int32 tileSize = is4bpp ? 32 : 64;
+        Int32 tiles = (length + tileSize - 1) / tileSize;
+        Int32 columns = width / 8;
+        m_Height = ((tiles + columns - 1) / columns) * 8;
+        m_Width = width;
+        m_Is4Bpp = is4bpp;
+
+        // Only 4bpp images can be stored packed
+        m_IsPacked = m_IsPacked && is4bpp;
+        m_Data.resize(m_IsPacked ? m_Width*m_Height/2 : m_Width*m_Height);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void Image::convertFromGBA(const QByteArray &data, Int32 width, Boolean is4bpp)
+    {
+        allocate(data.size(), width, is4bpp);
+
+        // Expands the tiles to one index byte per pixel
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(data.constData());
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Data.data());
+        if (m_IsPacked)
+            TileCodec::decode4bppPacked(input, data.size(), m_Width, m_Height, output);
+        else if (is4bpp)
+            TileCodec::decode4bpp(input, data.size(), m_Width, m_Height, output);
+        else
+            TileCodec::decode8bpp(input, data.size(), m_Width, m_Height, output);
+    }
+
     ///////////////////////////////////////////////////////////
     void Image::convertToGBA()
     {
-        // Combines two consecutive indices into one byte
-        for (int y = 0; y < m_Height-7; y+=8)
+        // Raw data given by setRaw might not cover the whole image
+        Int32 length = m_IsPacked ? m_Width*m_Height/2 : m_Width*m_Height;
+        QByteArray data = m_Data;
+        if (data.size() < length)
+            data.append(QByteArray(length - data.size(), 0));
+
+        // Allocates the whole buffer once, then packs every tile
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(data.constData());
+        m_Buffer.clear();
+
+        if (m_IsPacked)
         {
-            for (int x = 0; x < m_Width-7; x+=8)
-            {
-                for (int y2 = 0; y2 < 8; y2++)
-                {
-                    for (int x2 = 0; x2 < 8; x2+=2)
-                    {
-                        Int8 pixel1 = m_Data[(x+x2+0)+((y+y2)*m_Height)];
-                        Int8 pixel2 = m_Data[(x+x2+1)+((y+y2)*m_Height)];
-                        m_Buffer.push_back((Int8)((pixel2 << 4) | pixel1));
-                    }
-                }
-            }
+            // Copies the rows of every tile as they are
+            m_Buffer.resize(length);
+            TileCodec::encode4bppPacked(input, m_Width, m_Height, reinterpret_cast<UInt8 *>(m_Buffer.data()));
+        }
+        else if (m_Is4Bpp)
+        {
+            // Combines two consecutive indices into one byte
+            m_Buffer.resize(m_Width*m_Height/2);
+            TileCodec::encode4bpp(input, m_Width, m_Height, reinterpret_cast<UInt8 *>(m_Buffer.data()));
+        }
+        else
+        {
+            // Gathers the indices of every tile
+            m_Buffer.resize(m_Width*m_Height);
+            TileCodec::encode8bpp(input, m_Width, m_Height, reinterpret_cast<UInt8 *>(m_Buffer.data()));
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QByteArray &Image::compressed()
+    {
+        // The cache is keyed to the GBA data it was created from. If
+        // the data changed, only the modified part is re-encoded.
+        if (m_Encoded.isEmpty())
+        {
+            m_Encoded = Lz77::compressParallel(m_Buffer, &m_Checkpoints);
+            m_EncodedKey = m_Buffer;
+        }
+        else if (m_EncodedKey != m_Buffer)
+        {
+            m_Encoded = Lz77::recompress(m_Buffer, m_EncodedKey, m_Encoded, &m_Checkpoints);
+            m_EncodedKey = m_Buffer;
         }
+
+        return m_Encoded;
     }
 
 
@@ -304,6 +372,37 @@ namespace qboy
         return m_Data;
     }
 
+    ///////////////////////////////////////////////////////////
+    UInt8 Image::pixel(Int32 x, Int32 y) const
+    {
+        Q_ASSERT(x >= 0 && x < m_Width && y >= 0 && y < m_Height);
+        Int32 index = x + y * m_Width;
+        const UInt8 *data = reinterpret_cast<const UInt8 *>(m_Data.constData());
+
+        if (m_IsPacked)
+            return (data[index >> 1] >> ((index & 1) * 4)) & 0x0F;
+        else
+            return data[index];
+    }
+
+    ///////////////////////////////////////////////////////////
+    Image::PixelIterator Image::begin() const
+    {
+        return PixelIterator(reinterpret_cast<const UInt8 *>(m_Data.constData()), 0, m_IsPacked);
+    }
+
+    ///////////////////////////////////////////////////////////
+    Image::PixelIterator Image::end() const
+    {
+        return PixelIterator(reinterpret_cast<const UInt8 *>(m_Data.constData()), m_Width*m_Height, m_IsPacked);
+    }
+
+    ///////////////////////////////////////////////////////////
+    Boolean Image::isPacked() const
+    {
+        return m_IsPacked;
+    }
+
     ///////////////////////////////////////////////////////////
     QSize Image::size() const
     {
@@ -322,6 +421,68 @@ namespace qboy
         m_Data = raw;
     }
 
+    ///////////////////////////////////////////////////////////
+    void Image::setPixel(Int32 x, Int32 y, UInt8 index)
+    {
+        Q_ASSERT(x >= 0 && x < m_Width && y >= 0 && y < m_Height);
+        Int32 position = x + y * m_Width;
+        UInt8 *data = reinterpret_cast<UInt8 *>(m_Data.data());
+
+        if (m_IsPacked)
+        {
+            Int32 shift = (position & 1) * 4;
+            data[position >> 1] = (UInt8)((data[position >> 1] & ~(0x0F << shift)) | ((index & 0x0F) << shift));
+        }
+        else
+        {
+            data[position] = index;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Image::setPacked(Boolean packed)
+    {
+        if (packed == m_IsPacked)
+            return true;
+
+        // Applies to the next image read, if there are no pixels yet
+        if (m_Data.isEmpty())
+        {
+            m_IsPacked = packed;
+            return true;
+        }
+        else if (packed && !m_Is4Bpp)
+        {
+            return false;
+        }
+
+
+        // Converts the existing pixels to the new storage mode
+        Int32 count = m_Width*m_Height;
+        QByteArray data(packed ? count / 2 : count, 0);
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(m_Data.constData());
+        UInt8 *output = reinterpret_cast<UInt8 *>(data.data());
+        Int32 available = m_Data.size();
+
+        if (packed)
+        {
+            for (Int32 i = 0; i + 1 < qMin(count, available); i += 2)
+                output[i >> 1] = (UInt8)((input[i] & 0x0F) | ((input[i+1] & 0x0F) << 4));
+        }
+        else
+        {
+            for (Int32 i = 0; i < qMin(count / 2, available); i++)
+            {
+                output[i*2+0] = input[i] & 0x0F;
+                output[i*2+1] = input[i] >> 4;
+            }
+        }
+
+        m_Data = data;
+        m_IsPacked = packed;
+        return true;
+    }
+
     ///////////////////////////////////////////////////////////
     void Image::setPalette(Palette *palette)
     {
@@ -0,0 +1,438 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/ImageImporter.hpp>
+#include <QBoy/Graphics/ImportErrors.hpp>
+#include <QBoy/Graphics/TileCodec.hpp>
+#include <QFile>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Import definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define IMPORT_PNG_SIGNATURE    "\x89PNG\r\n\x1A\n"
+    #define IMPORT_PNG_INDEXED      3
+    #define IMPORT_BMP_HEADER       14
+    #define IMPORT_BMP_INFO         40
+    #define IMPORT_BMP_INFO_MAX     124             // BITMAPV5HEADER
+    #define IMPORT_MAX_PIXELS       (4096 * 4096)
+    #define IMPORT_MAX_DATA         (64 * 1024 * 1024)
+
+
+    ///////////////////////////////////////////////////////////
+    /// Reads big-endian (PNG) and little-endian (BMP) values.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline UInt32 import_be32(const char *data)
+    {
+        const UInt8 *d = reinterpret_cast<const UInt8 *>(data);
+        return (d[0] << 24) | (d[1] << 16) | (d[2] << 8) | d[3];
+    }
+
+    inline UInt32 import_le32(const char *data)
+    {
+        const UInt8 *d = reinterpret_cast<const UInt8 *>(data);
+        return d[0] | (d[1] << 8) | (d[2] << 16) | (d[3] << 24);
+    }
+
+    inline UInt16 import_le16(const char *data)
+    {
+        const UInt8 *d = reinterpret_cast<const UInt8 *>(data);
+        return static_cast<UInt16>(d[0] | (d[1] << 8));
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Expands one row of 1, 2, 4 or 8-bit pixels to indices.
+    /// The leftmost pixel is in the most significant bits.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void import_row(const UInt8 *row, Int32 depth, Int32 width, UInt8 *output)
+    {
+        if (depth == 8)
+        {
+            std::memcpy(output, row, width);
+            return;
+        }
+
+        Int32 perByte = 8 / depth;
+        UInt8 mask = static_cast<UInt8>((1 << depth) - 1);
+        for (Int32 x = 0; x < width; x++)
+        {
+            Int32 shift = 8 - depth * (x % perByte + 1);
+            output[x] = (row[x / perByte] >> shift) & mask;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Reverts the PNG filter of one row in place. Indexed
+    /// pixels never span more than one byte.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline bool import_unfilter(UInt8 filter, UInt8 *row, const UInt8 *previous, Int32 length)
+    {
+        switch (filter)
+        {
+            case 0:
+                return true;
+            case 1:
+                for (Int32 i = 1; i < length; i++)
+                    row[i] += row[i-1];
+                return true;
+            case 2:
+                for (Int32 i = 0; i < length; i++)
+                    row[i] += previous[i];
+                return true;
+            case 3:
+                for (Int32 i = 0; i < length; i++)
+                    row[i] += static_cast<UInt8>(((i > 0 ? row[i-1] : 0) + previous[i]) / 2);
+                return true;
+            case 4:
+                for (Int32 i = 0; i < length; i++)
+                {
+                    Int32 a = (i > 0) ? row[i-1] : 0;
+                    Int32 b = previous[i];
+                    Int32 c = (i > 0) ? previous[i-1] : 0;
+                    Int32 p = a + b - c;
+                    Int32 pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                    row[i] += static_cast<UInt8>((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    ImageImporter::ImageImporter()
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &ImageImporter::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool ImageImporter::read(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            m_LastError = IMP_ERROR_FILE;
+            return false;
+        }
+
+        bool result = read(&file);
+        file.close();
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool ImageImporter::read(QIODevice *device)
+    {
+        QByteArray signature = device->read(8);
+        if (signature == QByteArray(IMPORT_PNG_SIGNATURE, 8))
+            return readPng(device);
+        else if (signature.size() == 8 && signature.startsWith("BM"))
+            return readBmp(device, signature);
+
+        m_LastError = IMP_ERROR_FORMAT;
+        return false;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool ImageImporter::readPng(QIODevice *device)
+    {
+        Int32 width = 0, height = 0, depth = 0;
+        Boolean hasHeader = false;
+        QVector<Color> colors;
+        QByteArray deflated;
+
+
+        // Gathers the header, the palette and the pixel data
+        while (true)
+        {
+            QByteArray header = device->read(8);
+            if (header.size() != 8)
+            {
+                m_LastError = IMP_ERROR_DATA;
+                return false;
+            }
+
+            // Chunk lengths come from the file; bounds them before reading
+            UInt32 length = import_be32(header.constData());
+            QByteArray type = header.mid(4, 4);
+            if (length > IMPORT_MAX_DATA || deflated.size() + static_cast<qint64>(length) > IMPORT_MAX_DATA)
+            {
+                m_LastError = IMP_ERROR_DATA;
+                return false;
+            }
+
+            QByteArray body = device->read(length);
+            if (body.size() != static_cast<Int32>(length) || device->read(4).size() != 4)
+            {
+                m_LastError = IMP_ERROR_DATA;
+                return false;
+            }
+
+            if (type == "IHDR")
+            {
+                if (length < 13)
+                {
+                    m_LastError = IMP_ERROR_DATA;
+                    return false;
+                }
+
+                hasHeader = true;
+                width = static_cast<Int32>(import_be32(body.constData()));
+                height = static_cast<Int32>(import_be32(body.constData() + 4));
+                depth = static_cast<UInt8>(body.at(8));
+
+                // Only non-interlaced indexed images are supported
+                if (body.at(9) != IMPORT_PNG_INDEXED || body.at(12) != 0)
+                {
+                    m_LastError = IMP_ERROR_FORMAT;
+                    return false;
+                }
+            }
+            else if (type == "PLTE")
+            {
+                for (Int32 i = 0; i + 2 < static_cast<Int32>(length); i += 3)
+                    colors.push_back({ (UInt8)body.at(i), (UInt8)body.at(i+1), (UInt8)body.at(i+2), 255 });
+            }
+            else if (type == "IDAT")
+            {
+                deflated.append(body);
+            }
+            else if (type == "IEND")
+            {
+                break;
+            }
+        }
+
+        if (!hasHeader || (depth != 1 && depth != 2 && depth != 4 && depth != 8) || colors.isEmpty())
+        {
+            m_LastError = IMP_ERROR_FORMAT;
+            return false;
+        }
+
+        if (!allocate(width, height))
+            return false;
+
+
+        // qUncompress expects the decompressed size up front. The size
+        // was bounded by allocate, thus it fits into 32 bits.
+        Int32 stride = static_cast<Int32>((static_cast<qint64>(width) * depth + 7) / 8);
+        Int32 expected = static_cast<Int32>((static_cast<qint64>(stride) + 1) * height);
+        QByteArray prefix;
+        prefix.append(static_cast<char>(expected >> 24));
+        prefix.append(static_cast<char>(expected >> 16));
+        prefix.append(static_cast<char>(expected >> 8));
+        prefix.append(static_cast<char>(expected));
+
+        QByteArray rows = qUncompress(prefix + deflated);
+        deflated.clear();
+        if (rows.size() < expected)
+        {
+            m_LastError = IMP_ERROR_DATA;
+            return false;
+        }
+
+
+        // Unfilters each row against the previous one and expands
+        // it right into the indices.
+        QByteArray zero(stride, '\0');
+        const UInt8 *previous = reinterpret_cast<const UInt8 *>(zero.constData());
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Indices.data());
+
+        for (Int32 y = 0; y < height; y++)
+        {
+            UInt8 *row = reinterpret_cast<UInt8 *>(rows.data()) + y * (stride + 1);
+            if (!import_unfilter(row[0], row + 1, previous, stride))
+            {
+                m_LastError = IMP_ERROR_DATA;
+                return false;
+            }
+
+            import_row(row + 1, depth, width, output + y * width);
+            previous = row + 1;
+        }
+
+        setColors(colors, depth);
+        m_Image.setRaw(m_Indices);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool ImageImporter::readBmp(QIODevice *device, const QByteArray &signature)
+    {
+        // The signature already covers the first eight bytes
+        QByteArray header = signature + device->read(IMPORT_BMP_HEADER - 8 + IMPORT_BMP_INFO);
+        if (header.size() != IMPORT_BMP_HEADER + IMPORT_BMP_INFO)
+        {
+            m_LastError = IMP_ERROR_DATA;
+            return false;
+        }
+
+        const char *data = header.constData();
+        UInt32 pixelOffset = import_le32(data + 10);
+        UInt32 infoSize = import_le32(data + 14);
+        Int32 width = static_cast<Int32>(import_le32(data + 18));
+        Int32 height = static_cast<Int32>(import_le32(data + 22));
+        Int32 depth = import_le16(data + 28);
+        UInt32 compression = import_le32(data + 30);
+        UInt32 used = import_le32(data + 46);
+
+        if ((depth != 1 && depth != 4 && depth != 8) || compression != 0 ||
+            infoSize < IMPORT_BMP_INFO || infoSize > IMPORT_BMP_INFO_MAX)
+        {
+            m_LastError = IMP_ERROR_FORMAT;
+            return false;
+        }
+
+        // Negative heights denote top-down images
+        Boolean topDown = (height < 0);
+        height = (height == INT_MIN) ? 0 : qAbs(height);
+        if (!allocate(width, height))
+            return false;
+
+
+        // Reads the palette: blue, green, red and a reserved byte
+        Int32 count = (used == 0 || used > (1u << depth)) ? (1 << depth) : static_cast<Int32>(used);
+        device->read(infoSize - IMPORT_BMP_INFO);
+        QByteArray entries = device->read(count * 4);
+        if (entries.size() != count * 4)
+        {
+            m_LastError = IMP_ERROR_DATA;
+            return false;
+        }
+
+        QVector<Color> colors;
+        for (Int32 i = 0; i < count; i++)
+            colors.push_back({ (UInt8)entries.at(i*4+2), (UInt8)entries.at(i*4+1), (UInt8)entries.at(i*4), 255 });
+
+
+        // Streams the rows, which are padded to four bytes
+        Int32 stride = static_cast<Int32>(((static_cast<qint64>(width) * depth + 31) / 32) * 4);
+        qint64 skip = static_cast<qint64>(pixelOffset) - (IMPORT_BMP_HEADER + infoSize + count * 4);
+        if (skip < 0 || skip > IMPORT_MAX_DATA || device->read(skip).size() != skip)
+        {
+            m_LastError = IMP_ERROR_DATA;
+            return false;
+        }
+
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Indices.data());
+        QByteArray row(stride, '\0');
+        for (Int32 i = 0; i < height; i++)
+        {
+            if (device->read(row.data(), stride) != stride)
+            {
+                m_LastError = IMP_ERROR_DATA;
+                return false;
+            }
+
+            Int32 y = topDown ? i : height - 1 - i;
+            import_row(reinterpret_cast<const UInt8 *>(row.constData()), depth, width, output + y * width);
+        }
+
+        setColors(colors, depth);
+        m_Image.setRaw(m_Indices);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool ImageImporter::allocate(Int32 width, Int32 height)
+    {
+        // Dimensions come from the file; bounds them before allocating
+        if (width <= 0 || height <= 0 || static_cast<qint64>(width) * height > IMPORT_MAX_PIXELS)
+        {
+            m_LastError = IMP_ERROR_SIZE;
+            return false;
+        }
+
+        if (!m_Image.setSize(width, height))
+        {
+            m_LastError = IMP_ERROR_ALIGN;
+            return false;
+        }
+
+        m_Indices = QByteArray(width * height, '\0');
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void ImageImporter::setColors(QVector<Color> colors, Int32 depth)
+    {
+        Int32 count = (depth <= 4 && colors.size() <= 16) ? 16 : 256;
+        colors.resize(count);
+        m_Palette.setRaw(colors);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const Image &ImageImporter::image() const
+    {
+        return m_Image;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const Palette &ImageImporter::palette() const
+    {
+        return m_Palette;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray ImageImporter::toGBA(Boolean is4bpp) const
+    {
+        Int32 width = m_Image.size().width();
+        Int32 height = m_Image.size().height();
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(m_Indices.constData());
+
+        QByteArray data(is4bpp ? width * height / 2 : width * height, '\0');
+        UInt8 *output = reinterpret_cast<UInt8 *>(data.data());
+
+        if (is4bpp)
+            TileCodec::encode4bpp(input, width, height, output);
+        else
+            TileCodec::encode8bpp(input, width, height, output);
+
+        return data;
+    }
+}
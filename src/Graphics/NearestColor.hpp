@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+
+#ifndef __QBOY_NEARESTCOLOR_HPP__
+#define __QBOY_NEARESTCOLOR_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+#include <cstddef>
+#ifdef QBOY_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   NearestColor.hpp
+    /// \brief  Searches the nearest of several colors.
+    ///
+    /// Internal to the library; shared by the quantizer and the
+    /// remapper. Compares eight candidates at once with SSE2
+    /// where available.
+    ///
+    ///////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////
+    /// Finds the candidate nearest to the given color; of equally
+    /// near ones the first. Candidates are in separate channels
+    /// of up to 6 bits, so that distances fit into 16 bits, and
+    /// padded to a multiple of eight with copies of the first
+    /// candidate. Stores the squared distance, if requested.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline Int32 nearest_color(
+            const Int16 *cr,
+            const Int16 *cg,
+            const Int16 *cb,
+            Int32 count,
+            Int32 r,
+            Int32 g,
+            Int32 b,
+            Int32 *distance = NULL)
+    {
+        Int32 best = 0x7FFF;
+        Int32 index = 0;
+
+    #ifdef QBOY_SSE2
+        const __m128i vr = _mm_set1_epi16(static_cast<Int16>(r));
+        const __m128i vg = _mm_set1_epi16(static_cast<Int16>(g));
+        const __m128i vb = _mm_set1_epi16(static_cast<Int16>(b));
+        __m128i bestDist = _mm_set1_epi16(0x7FFF);
+        __m128i bestIndex = _mm_setzero_si128();
+        __m128i indices = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m128i eight = _mm_set1_epi16(8);
+
+        for (Int32 i = 0; i < count; i += 8)
+        {
+            __m128i dr = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cr + i)), vr);
+            __m128i dg = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cg + i)), vg);
+            __m128i db = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cb + i)), vb);
+            __m128i dist = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(dr, dr), _mm_mullo_epi16(dg, dg)), _mm_mullo_epi16(db, db));
+
+            __m128i closer = _mm_cmplt_epi16(dist, bestDist);
+            bestDist = _mm_min_epi16(dist, bestDist);
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, indices), _mm_andnot_si128(closer, bestIndex));
+            indices = _mm_add_epi16(indices, eight);
+        }
+
+        // Each lane holds the first of its nearest candidates
+        Int16 lanes[8], lanesIndex[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), bestDist);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanesIndex), bestIndex);
+        for (int i = 0; i < 8; i++)
+        {
+            if (lanes[i] < best || (lanes[i] == best && lanesIndex[i] < index))
+            {
+                best = lanes[i];
+                index = lanesIndex[i];
+            }
+        }
+    #else
+        for (Int32 i = 0; i < count; i++)
+        {
+            Int32 dr = cr[i] - r, dg = cg[i] - g, db = cb[i] - b;
+            Int32 dist = dr*dr + dg*dg + db*db;
+            if (dist < best)
+            {
+                best = dist;
+                index = i;
+            }
+        }
+    #endif
+
+        if (distance != NULL)
+            *distance = best;
+
+        return index;
+    }
+}
+
+
+#endif  // __QBOY_NEARESTCOLOR_HPP__
@@ -25,31 +25,80 @@
 //
 ///////////////////////////////////////////////////////////
 #include <QBoy/Core/Lz77.hpp>
+#include <QBoy/Graphics/ColorCodec.hpp>
 #include <QBoy/Graphics/Palette.hpp>
 #include <QBoy/Graphics/PaletteErrors.hpp>
-#include <cmath>
+#include <QMutexLocker>
 
 namespace qboy
 {
+    ///////////////////////////////////////////////////////////
+    // Definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define PAL_NO_OFFSET       0xFFFFFFFF
+
+
+    ///////////////////////////////////////////////////////////
+    /// \brief Holds the colors shared between palette copies.
+    ///
+    /// The RGBA, OpenGL and LZ77 forms are caches of the GBA
+    /// data; a detached copy starts without any of them.
+    ///
+    ///////////////////////////////////////////////////////////
+    class PaletteData : public QSharedData {
+    public:
+
+        PaletteData() : hasRGBA(false), hasGL(false) { }
+        PaletteData(const PaletteData &data)
+            : QSharedData(data), colors(data.colors), hasRGBA(false), hasGL(false) { }
+
+        QByteArray                  colors;
+        mutable QMutex              mutex;
+        mutable QVector<Color>      rgba;
+        mutable QVector<GLColor>    gl;
+        mutable QByteArray          encoded;
+        mutable Boolean             hasRGBA;
+        mutable Boolean             hasGL;
+    };
+
+
     ///////////////////////////////////////////////////////////
     // Constructors
     //
     ///////////////////////////////////////////////////////////
     Palette::Palette()
-        : m_DataSize(0),
-          m_ColorCount(0)
+        : m_Data(new PaletteData),
+          m_DataSize(0),
+          m_ColorCount(0),
+          m_Offset(PAL_NO_OFFSET)
     {
     }
 
     ///////////////////////////////////////////////////////////
     Palette::Palette(const Palette &pal)
         : m_Data(pal.m_Data),
-          m_DataGL(pal.m_DataGL),
           m_DataSize(pal.m_DataSize),
-          m_ColorCount(pal.m_ColorCount)
+          m_ColorCount(pal.m_ColorCount),
+          m_Offset(pal.m_Offset)
     {
     }
 
+    ///////////////////////////////////////////////////////////
+    Palette::~Palette()
+    {
+    }
+
+    ///////////////////////////////////////////////////////////
+    Palette &Palette::operator=(const Palette &pal)
+    {
+        m_Data = pal.m_Data;
+        m_DataSize = pal.m_DataSize;
+        m_ColorCount = pal.m_ColorCount;
+        m_Offset = pal.m_Offset;
+        return *this;
+    }
+
 
     ///////////////////////////////////////////////////////////
     // Member functions
@@ -69,8 +118,12 @@ namespace qboy
             return false;
         }
 
-        // Optimized: Reads all the half-words right away
-        return convertGBA(rom.readHWordTable(count));
+        // Optimized: Converts all the bytes right away
+        if (!convertGBA(rom.readBytes(m_DataSize)))
+            return false;
+
+        m_Offset = offset;
+        return true;
     }
 
     ///////////////////////////////////////////////////////////
@@ -92,83 +145,111 @@ namespace qboy
         }
 
 
-        // Defines required variables for the following algorithm
+        // Finally converts the GBA data to RGBA data
         m_ColorCount = (data.size() / 2);
-        QList<UInt16> entries;
-
-        // Converts the byte data to half-word data
-        for (int i = 0; i < m_ColorCount; i++)
-        {
-            UInt8 nibble1 = data.at(i*2);
-            UInt8 nibble2 = data.at(i*2+1);
-            entries.push_back(static_cast<UInt16>((nibble2 << 8) | nibble1));
-        }
+        if (!convertGBA(data))
+            return false;
 
-        // Finally converts the GBA data to RGBA data
-        return convertGBA(entries);
+        m_Offset = offset;
+        return true;
     }
 
     ///////////////////////////////////////////////////////////
     bool Palette::convertGBA(const QList<UInt16> &entries)
     {
-        m_Data.clear();
-        m_DataGL.clear();
+        QByteArray data(entries.size() * 2, '\0');
+        for (int i = 0; i < entries.size(); i++)
+        {
+            data[i*2+0] = static_cast<char>(entries.at(i) & 0xFF);
+            data[i*2+1] = static_cast<char>(entries.at(i) >> 8);
+        }
 
+        return convertGBA(data);
+    }
 
+    ///////////////////////////////////////////////////////////
+    bool Palette::convertGBA(const QByteArray &data)
+    {
         // Release mode will get to this point, even if invalid color count
-        if (m_ColorCount != 16 && m_ColorCount != 256)
+        if ((m_ColorCount != 16 && m_ColorCount != 256) || data.size() < m_ColorCount * 2)
         {
+            m_ColorCount = 0;
+            m_Data = QSharedDataPointer<PaletteData>(new PaletteData);
             m_LastError = PAL_ERROR_COUNT;
             return false;
         }
 
-
-        // Converts all color entries (internally)
-        for (int i = 0; i < m_ColorCount; i++)
-        {
-            UInt16 entry = entries.at(i);
-            UInt8 blue  = static_cast<UInt8>(((entry & 0x7C00) >> 0xA) * 8);
-            UInt8 green = static_cast<UInt8>(((entry & 0x03E0) >> 0x5) * 8);
-            UInt8 red   = static_cast<UInt8>(((entry & 0x001F) >> 0x0) * 8);
-
-            m_Data.push_back({ red, green, blue, 255 });
-            m_DataGL.push_back({ red/255.0f, green/255.0f, blue/255.0f, 1.0f });        
-        }
+        // Replaces the shared data instead of copying the old one
+        PaletteData *shared = new PaletteData;
+        shared->colors = data.left(m_ColorCount * 2);
+        m_Data = QSharedDataPointer<PaletteData>(shared);
 
         return true;
     }
 
     ///////////////////////////////////////////////////////////
-    void Palette::convertRaw()
+    const QByteArray &Palette::compressed() const
     {
-        // Buffers the converted data
-        for (int i = 0; i < m_ColorCount; i++)
-        {
-            const Color &entry = m_Data.at(i);
-            char red = (char)(floorf(entry.r / 8.0f));
-            char grn = (char)(floorf(entry.g / 8.0f));
-            char blu = (char)(floorf(entry.b / 8.0f));
-
-            // Converts the entry to a GBA color
-            Int16 color = (Int16)(red | (grn << 5) | (blu << 10));
-            m_Buffer.append((char)((color & 0xFF00) >> 8));
-            m_Buffer.append((char)(color & 0xFF));
-        }
+        const PaletteData *shared = m_Data.constData();
+        QMutexLocker lock(&shared->mutex);
+
+        if (shared->encoded.isEmpty())
+            shared->encoded = Lz77::compress(shared->colors);
+
+        return shared->encoded;
     }
 
 
     ///////////////////////////////////////////////////////////
     const QVector<Color> &Palette::raw() const
     {
-        return m_Data;
+        const PaletteData *shared = m_Data.constData();
+        QMutexLocker lock(&shared->mutex);
+
+        if (!shared->hasRGBA)
+        {
+            shared->rgba.resize(shared->colors.size() / 2);
+            ColorCodec::decodeBytes(
+                reinterpret_cast<const UInt8 *>(shared->colors.constData()),
+                shared->rgba.size(),
+                shared->rgba.data()
+            );
+
+            shared->hasRGBA = true;
+        }
+
+        return shared->rgba;
     }
 
     ///////////////////////////////////////////////////////////
     const QVector<GLColor> &Palette::rawGL() const
     {
-        return m_DataGL;
+        // The OpenGL colors are derived from the RGBA colors
+        const QVector<Color> &colors = raw();
+        const PaletteData *shared = m_Data.constData();
+        QMutexLocker lock(&shared->mutex);
+
+        if (!shared->hasGL)
+        {
+            shared->gl.resize(colors.size());
+            ColorCodec::toGL(colors.constData(), colors.size(), shared->gl.data());
+            shared->hasGL = true;
+        }
+
+        return shared->gl;
     }
 
+    ///////////////////////////////////////////////////////////
+    const QByteArray &Palette::rawGBA() const
+    {
+        return m_Data.constData()->colors;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 Palette::dataSize() const
+    {
+        return m_DataSize;
+    }
 
     ///////////////////////////////////////////////////////////
     const QString &Palette::lastError() const
@@ -187,15 +268,13 @@ namespace qboy
             return false;
         }
 
-        // Copies the new color list
-        m_Data = raw;
-        m_DataGL.clear();
-        m_ColorCount = raw.size();
-
+        // Encodes the new color list into fresh shared data
+        PaletteData *shared = new PaletteData;
+        shared->colors = QByteArray(raw.size() * 2, '\0');
+        ColorCodec::encodeBytes(raw.constData(), raw.size(), reinterpret_cast<UInt8 *>(shared->colors.data()));
 
-        // Converts to OpenGL data list
-        foreach (Color color, raw)
-            m_DataGL.push_back({ color.r/255.0f, color.g/255.0f, color.b/255.0f, 1.0f });
+        m_Data = QSharedDataPointer<PaletteData>(shared);
+        m_ColorCount = raw.size();
 
         return true;
     }
@@ -204,15 +283,14 @@ namespace qboy
     ///////////////////////////////////////////////////////////
     bool Palette::requiresRepoint(bool isCompressed)
     {
-        // Converts the palette to raw byte data
-        convertRaw();
-
-        // Retrieves the new data size
+        // Retrieves the new data size. If even the worst case
+        // fits, there is no need to compress the data at all.
+        const QByteArray &colors = rawGBA();
         int newSize = 0;
-        if (isCompressed)
-            newSize = Lz77::compress(m_Buffer).size();
-        else
-            newSize = m_Buffer.size();
+        if (isCompressed && Lz77::estimateSize(colors.size()) > m_DataSize)
+            newSize = compressed().size();
+        else if (!isCompressed)
+            newSize = colors.size();
 
         return newSize > m_DataSize;
     }
@@ -220,32 +298,54 @@ namespace qboy
     ///////////////////////////////////////////////////////////
     bool Palette::write(Rom &rom, UInt32 offset, Boolean lz77)
     {
-        // Converts to raw data, if not already
-        if (m_Buffer.isEmpty() || m_Buffer.isNull())
-            convertRaw();
+        const PaletteData *shared = m_Data.constData();
+        if (!rom.seek(offset))
+        {
+            m_LastError = PAL_ERROR_OFFSET;
+            return false;
+        }
+
+        // The old data may only be overwritten where it was read from
+        Int32 reserved = (offset == m_Offset) ? m_DataSize : 0;
 
-        // Converts the raw data to LZ77 data, if requested
-        if (lz77)
+        // Snapshots the cached LZ77 data; other threads may fill it
+        QByteArray encoded;
         {
-            m_Buffer = Lz77::compress(m_Buffer);
+            QMutexLocker lock(&shared->mutex);
+            encoded = shared->encoded;
+        }
 
-            if (m_Buffer.isNull() || m_Buffer.isEmpty())
+        // Streams the LZ77 data directly into the rom, unless it
+        // was already encoded for this exact data before.
+        if (lz77 && encoded.isEmpty())
+        {
+            Int32 size = 0;
+            if (!Lz77::compressInto(rom, offset, shared->colors, reserved, &size))
             {
-                m_LastError = PAL_ERROR_LZ77;
+                m_LastError = PAL_ERROR_SPACE;
                 return false;
             }
+
+            m_DataSize = size;
         }
-        if (!rom.seek(offset))
+        else if (lz77)
         {
-            m_LastError = PAL_ERROR_OFFSET;
-            return false;
-        }
-
+            if (!Lz77::writeInto(rom, offset, encoded, reserved))
+            {
+                m_LastError = PAL_ERROR_SPACE;
+                return false;
+            }
 
-        // Writes the palette to the ROM and clears the buffer
-        rom.writeBytes(m_Buffer);
-        m_Buffer.clear();
+            m_DataSize = encoded.size();
+        }
+        else
+        {
+            // Writes the palette to the ROM
+            rom.writeBytes(shared->colors);
+            m_DataSize = shared->colors.size();
+        }
 
+        m_Offset = offset;
         return true;
     }
 }
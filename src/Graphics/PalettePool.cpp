@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/PalettePool.hpp>
+#include <algorithm>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// Combines offset and compression into one location key.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline UInt64 pool_key(UInt32 offset, Boolean isCompressed)
+    {
+        return (static_cast<UInt64>(offset) << 1) | (isCompressed ? 1 : 0);
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Determines whether the bytes of the entry are unchanged.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline Boolean pool_valid(const Rom &rom, UInt32 offset, const PalettePoolEntry &entry)
+    {
+        return static_cast<UInt64>(offset) + entry.size <= rom.size() &&
+               qHashBits(rom.data() + offset, entry.size) == entry.hash;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    PalettePool::PalettePool()
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Member functions
+    //
+    ///////////////////////////////////////////////////////////
+    QSharedPointer<const Palette> PalettePool::readUncompressed(const Rom &rom, UInt32 offset, Int32 count)
+    {
+        UInt64 key = pool_key(offset, false);
+        auto it = m_Locations.constFind(key);
+        if (it != m_Locations.constEnd() &&
+            it.value().palette->rawGBA().size() / 2 == count &&
+            pool_valid(rom, offset, it.value()))
+            return it.value().palette;
+
+        Palette palette;
+        if (!palette.readUncompressed(rom, offset, count))
+        {
+            m_Locations.remove(key);
+            m_LastError = palette.lastError();
+            return QSharedPointer<const Palette>();
+        }
+
+        PalettePoolEntry entry;
+        entry.size = palette.dataSize();
+        entry.hash = qHashBits(rom.data() + offset, entry.size);
+        entry.palette = intern(palette);
+        m_Locations.insert(key, entry);
+        return entry.palette;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QSharedPointer<const Palette> PalettePool::readCompressed(const Rom &rom, UInt32 offset)
+    {
+        UInt64 key = pool_key(offset, true);
+        auto it = m_Locations.constFind(key);
+        if (it != m_Locations.constEnd() && pool_valid(rom, offset, it.value()))
+            return it.value().palette;
+
+        Palette palette;
+        if (!palette.readCompressed(rom, offset))
+        {
+            m_Locations.remove(key);
+            m_LastError = palette.lastError();
+            return QSharedPointer<const Palette>();
+        }
+
+        PalettePoolEntry entry;
+        entry.size = palette.dataSize();
+        entry.hash = qHashBits(rom.data() + offset, entry.size);
+        entry.palette = intern(palette);
+        m_Locations.insert(key, entry);
+        return entry.palette;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QSharedPointer<const Palette> PalettePool::intern(const Palette &palette)
+    {
+        // The key shares its data with the palette; costs no memory
+        const QByteArray &colors = palette.rawGBA();
+        QSharedPointer<const Palette> shared = m_Palettes.value(colors);
+        if (shared.isNull())
+        {
+            shared = QSharedPointer<const Palette>(new Palette(palette));
+            m_Palettes.insert(colors, shared);
+        }
+
+        return shared;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QList<QList<PaletteLocation>> PalettePool::duplicates(const Rom &rom)
+    {
+        // Groups all unchanged locations by the palette they resolved to
+        QHash<const Palette *, QList<PaletteLocation>> groups;
+        for (auto it = m_Locations.begin(); it != m_Locations.end();)
+        {
+            PaletteLocation location = { static_cast<UInt32>(it.key() >> 1), (it.key() & 1) != 0 };
+            if (!pool_valid(rom, location.offset, it.value()))
+            {
+                it = m_Locations.erase(it);
+                continue;
+            }
+
+            groups[it.value().palette.data()].push_back(location);
+            ++it;
+        }
+
+        QList<QList<PaletteLocation>> result;
+        foreach (QList<PaletteLocation> group, groups)
+        {
+            if (group.size() < 2)
+                continue;
+
+            std::sort(group.begin(), group.end(), [](const PaletteLocation &a, const PaletteLocation &b) {
+                return a.offset < b.offset || (a.offset == b.offset && a.isCompressed < b.isCompressed);
+            });
+
+            result.push_back(group);
+        }
+
+        // Orders the groups by their first location, for stable output
+        std::sort(result.begin(), result.end(), [](const QList<PaletteLocation> &a, const QList<PaletteLocation> &b) {
+            return a.first().offset < b.first().offset;
+        });
+
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 PalettePool::count() const
+    {
+        return m_Palettes.size();
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 PalettePool::locations() const
+    {
+        return m_Locations.size();
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QString &PalettePool::lastError() const
+    {
+        return m_LastError;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void PalettePool::clear()
+    {
+        m_Palettes.clear();
+        m_Locations.clear();
+    }
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+
+#ifndef __QBOY_PARALLEL_HPP__
+#define __QBOY_PARALLEL_HPP__
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Config.hpp>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// \date   18/10/2026
+    /// \file   Parallel.hpp
+    /// \brief  Splits graphics work across multiple cores.
+    ///
+    /// Internal to the library; shared by the tile codecs,
+    /// the renderers and the remapper.
+    ///
+    ///////////////////////////////////////////////////////////
+    #define PARALLEL_TILES      1024    // 32KB of 4bpp data
+    #define PARALLEL_BAND_LINES 16      // scanlines per job
+
+
+    ///////////////////////////////////////////////////////////
+    /// Splits the given amount of lines into bands and invokes
+    /// the functor with the first and past-the-last line of
+    /// each band; on multiple cores if there are several.
+    ///
+    ///////////////////////////////////////////////////////////
+    template <typename Function>
+    void parallel_bands(Int32 count, Int32 lines, Function function)
+    {
+        if (count <= lines)
+        {
+            if (count > 0)
+                function(0, count);
+
+            return;
+        }
+
+        QVector<Int32> bands;
+        for (Int32 first = 0; first < count; first += lines)
+            bands.push_back(first);
+
+        QtConcurrent::blockingMap(bands, [count, lines, &function](const Int32 &first)
+        {
+            function(first, qMin(first + lines, count));
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Invokes the functor for every row of tiles; on multiple
+    /// cores if there are many tiles.
+    ///
+    ///////////////////////////////////////////////////////////
+    template <typename Function>
+    void parallel_rows(Int32 rows, Int32 columns, Function function)
+    {
+        auto band = [&function](Int32 first, Int32 last)
+        {
+            for (Int32 row = first; row < last; row++)
+                function(row);
+        };
+
+        if (columns * rows < PARALLEL_TILES)
+            band(0, rows);
+        else
+            parallel_bands(rows, 1, band);
+    }
+}
+
+
+#endif  // __QBOY_PARALLEL_HPP__
@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/PngErrors.hpp>
+#include <QBoy/Graphics/PngWriter.hpp>
+#include <QFile>
+#include <QtConcurrent/QtConcurrentMap>
+#include <cstring>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // PNG definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define PNG_SIGNATURE       "\x89PNG\r\n\x1A\n"
+    #define PNG_COLOR_INDEXED   3
+
+
+    ///////////////////////////////////////////////////////////
+    /// Builds the CRC-32 table of the PNG specification.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct PngCrcTable
+    {
+        UInt32 entries[256];
+
+        PngCrcTable()
+        {
+            for (UInt32 n = 0; n < 256; n++)
+            {
+                UInt32 c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+
+                entries[n] = c;
+            }
+        }
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Computes the CRC-32 of the given bytes.
+    ///
+    ///////////////////////////////////////////////////////////
+    UInt32 png_crc(const char *data, Int32 length)
+    {
+        static const PngCrcTable table;
+
+        UInt32 crc = 0xFFFFFFFF;
+        for (Int32 i = 0; i < length; i++)
+            crc = table.entries[(crc ^ static_cast<UInt8>(data[i])) & 0xFF] ^ (crc >> 8);
+
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Appends a big-endian 32-bit value.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void png_word(QByteArray &output, UInt32 value)
+    {
+        output.append(static_cast<char>(value >> 24));
+        output.append(static_cast<char>(value >> 16));
+        output.append(static_cast<char>(value >> 8));
+        output.append(static_cast<char>(value));
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Appends one chunk: length, type, data and CRC.
+    ///
+    ///////////////////////////////////////////////////////////
+    void png_chunk(QByteArray &output, const char *type, const char *data, Int32 length)
+    {
+        png_word(output, static_cast<UInt32>(length));
+        Int32 start = output.size();
+        output.append(type, 4);
+        output.append(data, length);
+        png_word(output, png_crc(output.constData() + start, length + 4));
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    /// Checks whether the image can be stored with the palette.
+    /// Returns the error string or null if it can.
+    ///
+    ///////////////////////////////////////////////////////////
+    const char *png_check(const Image &image, const QVector<Color> &colors)
+    {
+        Int32 width = image.size().width();
+        Int32 height = image.size().height();
+        Int32 pixels = image.isPacked() ? width * height / 2 : width * height;
+        if (width <= 0 || height <= 0 || image.raw().size() < pixels || colors.isEmpty())
+            return PNG_ERROR_EMPTY;
+        if (colors.size() > 256)
+            return PNG_ERROR_COLORS;
+
+        // Every pixel must refer to an entry of the PLTE chunk
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(image.raw().constData());
+        UInt8 highest = 0;
+        for (Int32 i = 0; i < pixels; i++)
+        {
+            UInt8 index = image.isPacked() ? qMax(input[i] & 0x0F, input[i] >> 4) : input[i];
+            highest = qMax(highest, index);
+        }
+
+        if (highest >= colors.size())
+            return PNG_ERROR_INDEX;
+
+        return NULL;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    PngWriter::PngWriter()
+        : m_Level(-1),
+          m_Transparent(true)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &PngWriter::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void PngWriter::setLevel(Int32 level)
+    {
+        m_Level = qBound(-1, level, 9);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void PngWriter::setTransparent(Boolean transparent)
+    {
+        m_Transparent = transparent;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QByteArray PngWriter::encode(const Image &image, const Palette &palette) const
+    {
+        const char *error = NULL;
+        return encode(image, palette, &error);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray PngWriter::encode(const Image &image, const Palette &palette, const char **error) const
+    {
+        Int32 width = image.size().width();
+        Int32 height = image.size().height();
+        const QVector<Color> &colors = palette.raw();
+
+        *error = png_check(image, colors);
+        if (*error != NULL)
+            return QByteArray();
+
+
+        // Each row starts with the filter type; none is best for
+        // indexed images. 16 colors are stored as 4-bit pixels,
+        // the left one in the high nibble.
+        Boolean is4bpp = (colors.size() <= 16);
+        Int32 stride = is4bpp ? (width + 1) / 2 : width;
+        QByteArray rows((stride + 1) * height, '\0');
+        UInt8 *output = reinterpret_cast<UInt8 *>(rows.data());
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(image.raw().constData());
+
+        for (Int32 y = 0; y < height; y++)
+        {
+            UInt8 *row = output + y * (stride + 1) + 1;
+            if (is4bpp && image.isPacked())
+            {
+                const UInt8 *packed = input + y * (width / 2);
+                for (Int32 x = 0; x < stride; x++)
+                    row[x] = static_cast<UInt8>((packed[x] << 4) | (packed[x] >> 4));
+            }
+            else if (is4bpp)
+            {
+                const UInt8 *pixels = input + y * width;
+                for (Int32 x = 0; x < width; x++)
+                    row[x / 2] |= static_cast<UInt8>((pixels[x] & 0x0F) << ((x & 1) ? 0 : 4));
+            }
+            else if (image.isPacked())
+            {
+                for (Int32 x = 0; x < width; x++)
+                    row[x] = image.pixel(x, y);
+            }
+            else
+            {
+                std::memcpy(row, input + y * width, width);
+            }
+        }
+
+
+        QByteArray header;
+        png_word(header, static_cast<UInt32>(width));
+        png_word(header, static_cast<UInt32>(height));
+        header.append(static_cast<char>(is4bpp ? 4 : 8));
+        header.append(static_cast<char>(PNG_COLOR_INDEXED));
+        header.append(3, '\0'); // deflate, adaptive filters, no interlace
+
+        QByteArray entries;
+        foreach (const Color &color, colors)
+        {
+            entries.append(static_cast<char>(color.r));
+            entries.append(static_cast<char>(color.g));
+            entries.append(static_cast<char>(color.b));
+        }
+
+        // qCompress prefixes the zlib stream with its length
+        QByteArray deflated = qCompress(rows, m_Level);
+        const char transparency = '\0';
+
+        QByteArray file(PNG_SIGNATURE, 8);
+        file.reserve(8 + 25 + 12 + entries.size() + 13 + 12 + deflated.size() + 12);
+        png_chunk(file, "IHDR", header.constData(), header.size());
+        png_chunk(file, "PLTE", entries.constData(), entries.size());
+        if (m_Transparent)
+            png_chunk(file, "tRNS", &transparency, 1);
+
+        png_chunk(file, "IDAT", deflated.constData() + 4, deflated.size() - 4);
+        png_chunk(file, "IEND", NULL, 0);
+        return file;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool PngWriter::write(QIODevice *device, const Image &image, const Palette &palette)
+    {
+        const char *error = NULL;
+        QByteArray data = encode(image, palette, &error);
+        if (error != NULL)
+        {
+            m_LastError = error;
+            return false;
+        }
+
+        if (device->write(data) != data.size())
+        {
+            m_LastError = PNG_ERROR_WRITE;
+            return false;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool PngWriter::write(const QString &path, const Image &image, const Palette &palette)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            m_LastError = PNG_ERROR_FILE;
+            return false;
+        }
+
+        bool result = write(&file, image, palette);
+        file.close();
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 PngWriter::writeBatch(const QVector<PngEntry> &entries)
+    {
+        // Every job writes its own file; errors are gathered and
+        // reported after all of them have finished.
+        struct Job
+        {
+            const PngEntry *entry;
+            QString error;
+        };
+
+        m_LastError.clear();
+        QVector<Job> jobs(entries.size());
+        for (int i = 0; i < entries.size(); i++)
+            jobs[i].entry = &entries.at(i);
+
+        const PngWriter &writer = *this;
+        QtConcurrent::blockingMap(jobs, [&writer](Job &job)
+        {
+            PngWriter copy(writer);
+            if (!copy.write(job.entry->path, *job.entry->image, *job.entry->palette))
+                job.error = copy.lastError();
+        });
+
+
+        Int32 written = 0;
+        for (int i = jobs.size() - 1; i >= 0; i--)
+        {
+            if (jobs.at(i).error.isEmpty())
+                written++;
+            else
+                m_LastError = jobs.at(i).entry->path + ": " + jobs.at(i).error;
+        }
+
+        return written;
+    }
+}
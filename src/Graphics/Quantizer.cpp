@@ -0,0 +1,591 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Quantizer.hpp>
+#include <QBoy/Graphics/QuantizerErrors.hpp>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include "NearestColor.hpp"
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Quantizer definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define QUANTIZER_TRANSPARENT   -1
+    #define QUANTIZER_CHUNK         2048    // colors per job
+    #define QUANTIZER_REFINE        2       // tile reassignments
+
+
+    ///////////////////////////////////////////////////////////
+    /// Holds the centroids of a palette in separate channels,
+    /// with one bit of extra precision (0 to 62). Padded to a
+    /// multiple of eight with copies of the first centroid.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct QuantCentroids
+    {
+        QVector<Int16> r;
+        QVector<Int16> g;
+        QVector<Int16> b;
+        Int32 count;
+
+        void set(const QVector<Int16> &cr, const QVector<Int16> &cg, const QVector<Int16> &cb)
+        {
+            count = cr.size();
+            Int32 padded = (count + 7) & ~7;
+            r = cr; g = cg; b = cb;
+            r.resize(padded); g.resize(padded); b.resize(padded);
+
+            for (Int32 i = count; i < padded; i++)
+            {
+                r[i] = cr.at(0);
+                g[i] = cg.at(0);
+                b[i] = cb.at(0);
+            }
+        }
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Splits a 15-bit color into doubled channels.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void quant_split(Int32 color, Int32 &r, Int32 &g, Int32 &b)
+    {
+        r = (color & 0x1F) * 2;
+        g = ((color >> 5) & 0x1F) * 2;
+        b = ((color >> 10) & 0x1F) * 2;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Finds the nearest centroid; of equally near ones the
+    /// first. Stores the squared distance, if requested.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline Int32 quant_nearest(const QuantCentroids &centroids, Int32 r, Int32 g, Int32 b, Int32 *distance = NULL)
+    {
+        return nearest_color(
+                centroids.r.constData(),
+                centroids.g.constData(),
+                centroids.b.constData(),
+                centroids.count,
+                r, g, b, distance);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    /// Accumulated channels of the colors of one cluster.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct QuantSums
+    {
+        QVector<Int64> r, g, b, weight;
+
+        void reset(Int32 count)
+        {
+            r.fill(0, count); g.fill(0, count);
+            b.fill(0, count); weight.fill(0, count);
+        }
+    };
+
+    ///////////////////////////////////////////////////////////
+    /// Splits the weighted colors by median cut and refines
+    /// the result by k-means.
+    ///
+    /// \returns at most count centroids in doubled channels.
+    ///
+    ///////////////////////////////////////////////////////////
+    QuantCentroids quant_palette(const QVector<Int32> &colors, const QVector<UInt32> &weights, Int32 count, Int32 iterations)
+    {
+        QuantCentroids centroids;
+        QVector<Int16> cr, cg, cb;
+        if (colors.isEmpty())
+        {
+            cr.push_back(0); cg.push_back(0); cb.push_back(0);
+            centroids.set(cr, cg, cb);
+            return centroids;
+        }
+
+
+        // Median cut: boxes are ranges within the sorted indices
+        QVector<Int32> order(colors.size());
+        for (int i = 0; i < order.size(); i++)
+            order[i] = i;
+
+        QVector<QPair<Int32, Int32>> boxes;
+        boxes.push_back(qMakePair(0, order.size()));
+
+        while (boxes.size() < count)
+        {
+            // Picks the box with the widest channel range
+            Int32 widest = -1, range = 0, channel = 0;
+            for (int i = 0; i < boxes.size(); i++)
+            {
+                Int32 low[3] = { 31, 31, 31 }, high[3] = { 0, 0, 0 };
+                for (Int32 j = boxes.at(i).first; j < boxes.at(i).second; j++)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        Int32 value = (colors.at(order.at(j)) >> (c * 5)) & 0x1F;
+                        low[c] = qMin(low[c], value);
+                        high[c] = qMax(high[c], value);
+                    }
+                }
+
+                for (int c = 0; c < 3; c++)
+                {
+                    if (high[c] - low[c] > range)
+                    {
+                        widest = i;
+                        range = high[c] - low[c];
+                        channel = c;
+                    }
+                }
+            }
+
+            if (widest < 0)
+                break;
+
+            // Splits at the weighted median of that channel
+            Int32 first = boxes.at(widest).first, last = boxes.at(widest).second;
+            Int32 shift = channel * 5;
+            std::sort(order.begin() + first, order.begin() + last, [&](Int32 a, Int32 b)
+            {
+                return ((colors.at(a) >> shift) & 0x1F) < ((colors.at(b) >> shift) & 0x1F);
+            });
+
+            Int64 total = 0, half = 0;
+            for (Int32 j = first; j < last; j++)
+                total += weights.at(order.at(j));
+
+            Int32 split = first + 1;
+            for (Int32 j = first; j < last - 1; j++)
+            {
+                half += weights.at(order.at(j));
+                split = j + 1;
+                if (half * 2 >= total)
+                    break;
+            }
+
+            boxes[widest].second = split;
+            boxes.push_back(qMakePair(split, last));
+        }
+
+        // The weighted mean of each box is its initial centroid
+        for (int i = 0; i < boxes.size(); i++)
+        {
+            Int64 sr = 0, sg = 0, sb = 0, sw = 0;
+            for (Int32 j = boxes.at(i).first; j < boxes.at(i).second; j++)
+            {
+                Int32 r, g, b;
+                quant_split(colors.at(order.at(j)), r, g, b);
+                UInt32 w = weights.at(order.at(j));
+                sr += r * w; sg += g * w; sb += b * w; sw += w;
+            }
+
+            cr.push_back(static_cast<Int16>((sr + sw / 2) / sw));
+            cg.push_back(static_cast<Int16>((sg + sw / 2) / sw));
+            cb.push_back(static_cast<Int16>((sb + sw / 2) / sw));
+        }
+
+        centroids.set(cr, cg, cb);
+
+
+        // K-means: the colors are assigned in chunks on all cores
+        QVector<Int32> starts;
+        for (Int32 i = 0; i < colors.size(); i += QUANTIZER_CHUNK)
+            starts.push_back(i);
+
+        QVector<QuantSums> sums(starts.size());
+        for (Int32 iteration = 0; iteration < iterations; iteration++)
+        {
+            const QuantCentroids &current = centroids;
+            QuantSums *partial = sums.data();
+            auto assign = [&current, &colors, &weights, partial](const Int32 &start)
+            {
+                QuantSums &target = partial[start / QUANTIZER_CHUNK];
+                target.reset(current.count);
+
+                Int32 end = qMin(start + QUANTIZER_CHUNK, colors.size());
+                for (Int32 i = start; i < end; i++)
+                {
+                    Int32 r, g, b;
+                    quant_split(colors.at(i), r, g, b);
+                    Int32 nearest = quant_nearest(current, r, g, b);
+                    UInt32 w = weights.at(i);
+
+                    target.r[nearest] += r * w;
+                    target.g[nearest] += g * w;
+                    target.b[nearest] += b * w;
+                    target.weight[nearest] += w;
+                }
+            };
+
+            if (starts.size() == 1)
+                assign(starts.at(0));
+            else
+                QtConcurrent::blockingMap(starts, assign);
+
+
+            // Moves each centroid to the mean of its colors
+            Boolean moved = false;
+            for (Int32 k = 0; k < centroids.count; k++)
+            {
+                Int64 sr = 0, sg = 0, sb = 0, sw = 0;
+                for (int s = 0; s < sums.size(); s++)
+                {
+                    sr += sums.at(s).r.at(k); sg += sums.at(s).g.at(k);
+                    sb += sums.at(s).b.at(k); sw += sums.at(s).weight.at(k);
+                }
+
+                if (sw == 0)
+                    continue;
+
+                Int16 nr = static_cast<Int16>((sr + sw / 2) / sw);
+                Int16 ng = static_cast<Int16>((sg + sw / 2) / sw);
+                Int16 nb = static_cast<Int16>((sb + sw / 2) / sw);
+                moved |= (nr != cr.at(k) || ng != cg.at(k) || nb != cb.at(k));
+                cr[k] = nr; cg[k] = ng; cb[k] = nb;
+            }
+
+            centroids.set(cr, cg, cb);
+            if (!moved)
+                break;
+        }
+
+        return centroids;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Converts the centroids to a palette with a transparent
+    /// color zero, padded to the given size.
+    ///
+    ///////////////////////////////////////////////////////////
+    Palette quant_output(const QuantCentroids &centroids, Int32 size)
+    {
+        QVector<Color> colors(size);
+        colors[0] = { 0, 0, 0, 255 };
+
+        for (Int32 i = 0; i < centroids.count && i + 1 < size; i++)
+        {
+            // Rounds the doubled channels to five bits
+            Int32 r = qMin(31, (centroids.r.at(i) + 1) / 2);
+            Int32 g = qMin(31, (centroids.g.at(i) + 1) / 2);
+            Int32 b = qMin(31, (centroids.b.at(i) + 1) / 2);
+            colors[i + 1] = { (UInt8)(r << 3), (UInt8)(g << 3), (UInt8)(b << 3), 255 };
+        }
+
+        Palette palette;
+        palette.setRaw(colors);
+        return palette;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Gathers the distinct colors of the given pixels.
+    ///
+    ///////////////////////////////////////////////////////////
+    void quant_histogram(
+            const QVector<Int32> &pixels,
+            const QVector<Int32> &positions,
+            QVector<Int32> &colors,
+            QVector<UInt32> &weights)
+    {
+        QVector<UInt32> histogram(0x8000, 0);
+        foreach (Int32 position, positions)
+        {
+            Int32 color = pixels.at(position);
+            if (color != QUANTIZER_TRANSPARENT)
+                histogram[color]++;
+        }
+
+        colors.clear();
+        weights.clear();
+        for (Int32 color = 0; color < 0x8000; color++)
+        {
+            if (histogram.at(color) != 0)
+            {
+                colors.push_back(color);
+                weights.push_back(histogram.at(color));
+            }
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    Quantizer::Quantizer()
+        : m_Iterations(8)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &Quantizer::lastError() const
+    {
+        return m_LastError;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void Quantizer::setIterations(Int32 iterations)
+    {
+        m_Iterations = qMax(0, iterations);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool Quantizer::prepare(const QVector<Color> &pixels, Int32 width, Int32 height)
+    {
+        if (width <= 0 || height <= 0 || width * height != pixels.size() || !m_Image.setSize(width, height))
+        {
+            m_LastError = QNT_ERROR_SIZE;
+            return false;
+        }
+
+        // Reduces the pixels to 15-bit colors right away
+        m_Colors.resize(pixels.size());
+        for (int i = 0; i < pixels.size(); i++)
+        {
+            const Color &color = pixels.at(i);
+            m_Colors[i] = (color.a < 128) ? QUANTIZER_TRANSPARENT :
+                ((color.r >> 3) | ((color.g >> 3) << 5) | ((color.b >> 3) << 10));
+        }
+
+        m_Palettes.clear();
+        m_Banks.fill(0, (width / 8) * (height / 8));
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Quantizer::quantize(const QVector<Color> &pixels, Int32 width, Int32 height, Int32 colors)
+    {
+        if (colors != 16 && colors != 256)
+        {
+            m_LastError = QNT_ERROR_COUNT;
+            return false;
+        }
+
+        if (!prepare(pixels, width, height))
+            return false;
+
+
+        QVector<Int32> positions(m_Colors.size());
+        for (int i = 0; i < positions.size(); i++)
+            positions[i] = i;
+
+        QVector<Int32> distinct;
+        QVector<UInt32> weights;
+        quant_histogram(m_Colors, positions, distinct, weights);
+        QuantCentroids centroids = quant_palette(distinct, weights, colors - 1, m_Iterations);
+
+
+        // Maps every distinct color once, then the pixels by table
+        QVector<UInt8> lookup(0x8000, 0);
+        foreach (Int32 color, distinct)
+        {
+            Int32 r, g, b;
+            quant_split(color, r, g, b);
+            lookup[color] = static_cast<UInt8>(quant_nearest(centroids, r, g, b) + 1);
+        }
+
+        QByteArray indices(m_Colors.size(), '\0');
+        for (int i = 0; i < m_Colors.size(); i++)
+            if (m_Colors.at(i) != QUANTIZER_TRANSPARENT)
+                indices[i] = static_cast<char>(lookup.at(m_Colors.at(i)));
+
+        m_Image.setRaw(indices);
+        m_Palettes.push_back(quant_output(centroids, colors));
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Quantizer::quantizeTiles(const QVector<Color> &pixels, Int32 width, Int32 height, Int32 palettes)
+    {
+        if (palettes < 1 || palettes > 16)
+        {
+            m_LastError = QNT_ERROR_COUNT;
+            return false;
+        }
+
+        if (!prepare(pixels, width, height))
+            return false;
+
+
+        // Gathers the pixel positions of each tile
+        Int32 columns = width / 8;
+        Int32 tiles = columns * (height / 8);
+        QVector<QVector<Int32>> positions(tiles);
+        for (Int32 tile = 0; tile < tiles; tile++)
+        {
+            positions[tile].reserve(64);
+            for (int y = 0; y < 8; y++)
+                for (int x = 0; x < 8; x++)
+                    positions[tile].push_back(((tile / columns) * 8 + y) * width + (tile % columns) * 8 + x);
+        }
+
+        // Groups the tiles by their mean colors first
+        QVector<Int32> means;
+        QVector<UInt32> ones;
+        for (Int32 tile = 0; tile < tiles; tile++)
+        {
+            Int64 sr = 0, sg = 0, sb = 0, count = 0;
+            foreach (Int32 position, positions.at(tile))
+            {
+                Int32 color = m_Colors.at(position);
+                if (color == QUANTIZER_TRANSPARENT)
+                    continue;
+
+                sr += color & 0x1F; sg += (color >> 5) & 0x1F; sb += (color >> 10) & 0x1F;
+                count++;
+            }
+
+            if (count == 0)
+                count = 1;
+
+            means.push_back(static_cast<Int32>((sr / count) | ((sg / count) << 5) | ((sb / count) << 10)));
+            ones.push_back(1);
+        }
+
+        QuantCentroids groups = quant_palette(means, ones, palettes, m_Iterations);
+        for (Int32 tile = 0; tile < tiles; tile++)
+        {
+            Int32 r, g, b;
+            quant_split(means.at(tile), r, g, b);
+            m_Banks[tile] = static_cast<UInt8>(quant_nearest(groups, r, g, b));
+        }
+
+
+        // Builds the sub-palettes and moves every tile to the one
+        // that represents it best, a few times over.
+        QVector<QuantCentroids> subs(palettes);
+        QVector<Int32> banks(palettes);
+        for (Int32 i = 0; i < palettes; i++)
+            banks[i] = i;
+
+        for (Int32 pass = 0; pass <= QUANTIZER_REFINE; pass++)
+        {
+            const QVector<Int32> &colors = m_Colors;
+            const QVector<UInt8> &assigned = m_Banks;
+            const Int32 iterations = m_Iterations;
+            QuantCentroids *output = subs.data();
+
+            QtConcurrent::blockingMap(banks, [&](const Int32 &bank)
+            {
+                QVector<Int32> members;
+                for (Int32 tile = 0; tile < tiles; tile++)
+                    if (assigned.at(tile) == bank)
+                        foreach (Int32 position, positions.at(tile))
+                            members.push_back(position);
+
+                QVector<Int32> distinct;
+                QVector<UInt32> weights;
+                quant_histogram(colors, members, distinct, weights);
+                output[bank] = quant_palette(distinct, weights, 15, iterations);
+            });
+
+            if (pass == QUANTIZER_REFINE)
+                break;
+
+            QVector<Int32> indices(tiles);
+            for (Int32 tile = 0; tile < tiles; tile++)
+                indices[tile] = tile;
+
+            UInt8 *target = m_Banks.data();
+            QtConcurrent::blockingMap(indices, [&](const Int32 &tile)
+            {
+                Int64 best = -1;
+                for (Int32 bank = 0; bank < subs.size(); bank++)
+                {
+                    Int64 error = 0;
+                    foreach (Int32 position, positions.at(tile))
+                    {
+                        if (colors.at(position) == QUANTIZER_TRANSPARENT)
+                            continue;
+
+                        Int32 r, g, b, distance;
+                        quant_split(colors.at(position), r, g, b);
+                        quant_nearest(subs.at(bank), r, g, b, &distance);
+                        error += distance;
+                    }
+
+                    if (best < 0 || error < best)
+                    {
+                        best = error;
+                        target[tile] = static_cast<UInt8>(bank);
+                    }
+                }
+            });
+        }
+
+
+        // Maps each pixel within the sub-palette of its tile
+        QByteArray indices(m_Colors.size(), '\0');
+        for (Int32 tile = 0; tile < tiles; tile++)
+        {
+            const QuantCentroids &sub = subs.at(m_Banks.at(tile));
+            foreach (Int32 position, positions.at(tile))
+            {
+                Int32 color = m_Colors.at(position);
+                if (color == QUANTIZER_TRANSPARENT)
+                    continue;
+
+                Int32 r, g, b;
+                quant_split(color, r, g, b);
+                indices[position] = static_cast<char>(quant_nearest(sub, r, g, b) + 1);
+            }
+        }
+
+        m_Image.setRaw(indices);
+        foreach (const QuantCentroids &sub, subs)
+            m_Palettes.push_back(quant_output(sub, 16));
+
+        return true;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const Image &Quantizer::image() const
+    {
+        return m_Image;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QList<Palette> &Quantizer::palettes() const
+    {
+        return m_Palettes;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QVector<UInt8> &Quantizer::banks() const
+    {
+        return m_Banks;
+    }
+}
@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Remapper.hpp>
+#include <QBoy/Graphics/RemapperErrors.hpp>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include "NearestColor.hpp"
+#include "Parallel.hpp"
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Remapper definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define REMAPPER_COLORS         0x8000
+
+    const Int32 remap_bayer[4][4] =
+    {
+        {  0,  8,  2, 10 },
+        { 12,  4, 14,  6 },
+        {  3, 11,  1,  9 },
+        { 15,  7, 13,  5 }
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    /// Reduces an RGBA color to a 15-bit color.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline Int32 remap_color(Int32 r, Int32 g, Int32 b)
+    {
+        return (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Fills the lookup table for all 15-bit colors with the
+    /// given blue value. Candidates are in separate 5-bit
+    /// channels, padded to a multiple of eight.
+    ///
+    ///////////////////////////////////////////////////////////
+    void remap_plane(
+            Int32 blue,
+            const QVector<Int16> &cr,
+            const QVector<Int16> &cg,
+            const QVector<Int16> &cb,
+            const QVector<UInt8> &indices,
+            UInt8 *lookup)
+    {
+        for (Int32 green = 0; green < 32; green++)
+        {
+            for (Int32 red = 0; red < 32; red++)
+            {
+                Int32 index = nearest_color(
+                        cr.constData(),
+                        cg.constData(),
+                        cb.constData(),
+                        indices.size(),
+                        red, green, blue);
+
+                lookup[red | (green << 5) | (blue << 10)] = indices.at(index);
+            }
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    Remapper::Remapper()
+        : m_Spread(8)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &Remapper::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool Remapper::setPalette(const Palette &palette, Boolean reserveZero)
+    {
+        const QVector<Color> &colors = palette.raw();
+        Int32 first = (reserveZero && colors.size() > 1) ? 1 : 0;
+        if (colors.size() <= first)
+        {
+            m_LastError = RMP_ERROR_PALETTE;
+            return false;
+        }
+
+
+        // Candidates in separate channels, padded with the first
+        QVector<Int16> cr, cg, cb;
+        QVector<UInt8> indices;
+        for (Int32 i = first; i < colors.size(); i++)
+        {
+            cr.push_back(colors.at(i).r >> 3);
+            cg.push_back(colors.at(i).g >> 3);
+            cb.push_back(colors.at(i).b >> 3);
+            indices.push_back(static_cast<UInt8>(i));
+        }
+
+        while (cr.size() % 8 != 0)
+        {
+            cr.push_back(cr.at(0));
+            cg.push_back(cg.at(0));
+            cb.push_back(cb.at(0));
+        }
+
+
+        // Ordered dithering spreads pixels by the usual distance
+        // between neighbouring palette colors, per channel.
+        Real spacing = 0.0;
+        for (Int32 i = 0; i < indices.size(); i++)
+        {
+            Int32 closest = -1;
+            for (Int32 j = 0; j < indices.size(); j++)
+            {
+                Int32 dr = cr.at(i) - cr.at(j), dg = cg.at(i) - cg.at(j), db = cb.at(i) - cb.at(j);
+                Int32 dist = dr*dr + dg*dg + db*db;
+                if (i != j && dist != 0 && (closest < 0 || dist < closest))
+                    closest = dist;
+            }
+
+            if (closest > 0)
+                spacing += std::sqrt(closest / 3.0) * 8.0;
+        }
+
+        m_Spread = qBound(8, static_cast<Int32>(spacing / indices.size()), 255);
+
+
+        // Each job fills the table for one blue value
+        m_Lookup.resize(REMAPPER_COLORS);
+        m_Colors = colors;
+
+        QVector<Int32> planes(32);
+        for (Int32 blue = 0; blue < 32; blue++)
+            planes[blue] = blue;
+
+        UInt8 *lookup = m_Lookup.data();
+        QtConcurrent::blockingMap(planes, [&](const Int32 &blue)
+        {
+            remap_plane(blue, cr, cg, cb, indices, lookup);
+        });
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    UInt8 Remapper::nearest(const Color &color) const
+    {
+        Q_ASSERT(!m_Lookup.isEmpty());
+        return m_Lookup.at(remap_color(color.r, color.g, color.b));
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool Remapper::remap(const QVector<Color> &pixels, Int32 width, Int32 height, DitherMode mode)
+    {
+        if (m_Lookup.isEmpty())
+        {
+            m_LastError = RMP_ERROR_PALETTE;
+            return false;
+        }
+
+        if (width <= 0 || height <= 0 || width * height != pixels.size() || !m_Image.setSize(width, height))
+        {
+            m_LastError = RMP_ERROR_SIZE;
+            return false;
+        }
+
+
+        QByteArray indices(width * height, '\0');
+        UInt8 *output = reinterpret_cast<UInt8 *>(indices.data());
+        const Color *input = pixels.constData();
+        const UInt8 *lookup = m_Lookup.constData();
+
+        if (mode == DM_FloydSteinberg)
+        {
+            // The error of each pixel is spread to the right and to
+            // the row below, thus the rows are processed in order.
+            const Color *colors = m_Colors.constData();
+            QVector<Int32> errors(2 * (width + 2) * 3, 0);
+            Int32 *current = errors.data();
+            Int32 *next = errors.data() + (width + 2) * 3;
+
+            for (Int32 y = 0; y < height; y++)
+            {
+                for (Int32 x = 0; x < width; x++)
+                {
+                    const Color &pixel = input[y * width + x];
+                    if (pixel.a < 128)
+                        continue;
+
+                    Int32 *error = current + (x + 1) * 3;
+                    Int32 r = qBound(0, pixel.r + error[0] / 16, 255);
+                    Int32 g = qBound(0, pixel.g + error[1] / 16, 255);
+                    Int32 b = qBound(0, pixel.b + error[2] / 16, 255);
+
+                    UInt8 index = lookup[remap_color(r, g, b)];
+                    output[y * width + x] = index;
+
+                    Int32 diff[3] = { r - colors[index].r, g - colors[index].g, b - colors[index].b };
+                    Int32 *below = next + (x + 1) * 3;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        error[c + 3] += diff[c] * 7;
+                        below[c - 3] += diff[c] * 3;
+                        below[c + 0] += diff[c] * 5;
+                        below[c + 3] += diff[c] * 1;
+                    }
+                }
+
+                std::swap(current, next);
+                std::fill(next, next + (width + 2) * 3, 0);
+            }
+        }
+        else
+        {
+            // Shifts the colors by up to half the spread either way
+            Boolean ordered = (mode == DM_Ordered);
+            Int32 offsets[4][4];
+            for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++)
+                    offsets[y][x] = (remap_bayer[y][x] * 2 - 15) * m_Spread / 32;
+
+            // Without error diffusion, bands of rows are independent
+            parallel_bands(height, PARALLEL_BAND_LINES, [=](Int32 first, Int32 last)
+            {
+                for (Int32 y = first; y < last; y++)
+                {
+                    for (Int32 x = 0; x < width; x++)
+                    {
+                        const Color &pixel = input[y * width + x];
+                        if (pixel.a < 128)
+                            continue;
+
+                        if (!ordered)
+                        {
+                            output[y * width + x] = lookup[remap_color(pixel.r, pixel.g, pixel.b)];
+                            continue;
+                        }
+
+                        Int32 offset = offsets[y & 3][x & 3];
+                        output[y * width + x] = lookup[remap_color(
+                            qBound(0, pixel.r + offset, 255),
+                            qBound(0, pixel.g + offset, 255),
+                            qBound(0, pixel.b + offset, 255))];
+                    }
+                }
+            });
+        }
+
+        m_Image.setRaw(indices);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const Image &Remapper::image() const
+    {
+        return m_Image;
+    }
+}
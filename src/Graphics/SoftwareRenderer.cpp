@@ -0,0 +1,489 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/ColorCodec.hpp>
+#include <QBoy/Graphics/RendererErrors.hpp>
+#include <QBoy/Graphics/SoftwareRenderer.hpp>
+#include <cstring>
+#include "Parallel.hpp"
+#ifdef QBOY_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Renderer definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define RENDERER_LAYER_OBJ      4
+    #define RENDERER_LAYER_BD       5
+    #define RENDERER_NO_PRIORITY    4
+
+
+    ///////////////////////////////////////////////////////////
+    /// Flattens the given palettes to 256 BGR555 colors.
+    /// Returns false if they do not fit into 256 colors.
+    ///
+    ///////////////////////////////////////////////////////////
+    bool render_palettes(const QList<const Palette *> &palettes, QVector<UInt16> *colors)
+    {
+        QVector<UInt16> result(256, 0);
+        Int32 bank = 0;
+
+        for (int i = 0; i < palettes.size(); i++)
+        {
+            Int32 count = 0;
+            const UInt8 *gba = NULL;
+            if (palettes.at(i) != NULL)
+            {
+                const QByteArray &raw = palettes.at(i)->rawGBA();
+                gba = reinterpret_cast<const UInt8 *>(raw.constData());
+                count = raw.size() / 2;
+            }
+
+            // Palettes always start at a bank boundary
+            Int32 banks = qMax((count + 15) / 16, 1);
+            if (bank + banks * 16 > 256)
+                return false;
+
+            for (int j = 0; j < count; j++)
+                result[bank + j] = static_cast<UInt16>(gba[j * 2] | (gba[j * 2 + 1] << 8));
+
+            bank += banks * 16;
+        }
+
+        *colors = result;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Applies the effects of one scanline to 15-bit colors.
+    /// Mode holds one qboy::BlendMode per pixel.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void render_blend(
+            const UInt16 *top,
+            const UInt16 *bottom,
+            const UInt8 *mode,
+            Int32 count,
+            Int32 eva,
+            Int32 evb,
+            Int32 evy,
+            UInt16 *output)
+    {
+        Int32 x = 0;
+
+    #ifdef QBOY_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i five = _mm_set1_epi16(0x1F);
+        const __m128i va = _mm_set1_epi16(static_cast<Int16>(eva));
+        const __m128i vb = _mm_set1_epi16(static_cast<Int16>(evb));
+        const __m128i vy = _mm_set1_epi16(static_cast<Int16>(evy));
+
+        for (; x + 8 <= count; x += 8)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x));
+            __m128i modes = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(mode + x)), zero);
+            __m128i alpha = zero, bright = zero, dark = zero;
+
+            // Each channel occupies five bits of every 16-bit lane
+            for (int shift = 0; shift < 15; shift += 5)
+            {
+                __m128i count = _mm_cvtsi32_si128(shift);
+                __m128i ca = _mm_and_si128(_mm_srl_epi16(a, count), five);
+                __m128i cb = _mm_and_si128(_mm_srl_epi16(b, count), five);
+
+                __m128i sum = _mm_add_epi16(_mm_mullo_epi16(ca, va), _mm_mullo_epi16(cb, vb));
+                __m128i up = _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(five, ca), vy), 4);
+                __m128i down = _mm_srli_epi16(_mm_mullo_epi16(ca, vy), 4);
+
+                alpha = _mm_or_si128(alpha, _mm_sll_epi16(_mm_min_epi16(_mm_srli_epi16(sum, 4), five), count));
+                bright = _mm_or_si128(bright, _mm_sll_epi16(_mm_add_epi16(ca, up), count));
+                dark = _mm_or_si128(dark, _mm_sll_epi16(_mm_sub_epi16(ca, down), count));
+            }
+
+            // Selects the result of each pixel by its mode
+            __m128i isAlpha = _mm_cmpeq_epi16(modes, _mm_set1_epi16(BM_Alpha));
+            __m128i isBright = _mm_cmpeq_epi16(modes, _mm_set1_epi16(BM_Brighten));
+            __m128i isDark = _mm_cmpeq_epi16(modes, _mm_set1_epi16(BM_Darken));
+            __m128i isNone = _mm_cmpeq_epi16(modes, zero);
+
+            __m128i result = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(isNone, a), _mm_and_si128(isAlpha, alpha)),
+                _mm_or_si128(_mm_and_si128(isBright, bright), _mm_and_si128(isDark, dark)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + x), result);
+        }
+    #endif
+
+        for (; x < count; x++)
+        {
+            UInt16 a = top[x];
+            UInt16 b = bottom[x];
+            UInt16 result = 0;
+
+            for (int shift = 0; shift < 15; shift += 5)
+            {
+                Int32 ca = (a >> shift) & 0x1F;
+                Int32 cb = (b >> shift) & 0x1F;
+                Int32 channel = ca;
+
+                if (mode[x] == BM_Alpha)
+                    channel = qMin(31, (ca * eva + cb * evb) >> 4);
+                else if (mode[x] == BM_Brighten)
+                    channel = ca + (((31 - ca) * evy) >> 4);
+                else if (mode[x] == BM_Darken)
+                    channel = ca - ((ca * evy) >> 4);
+
+                result |= static_cast<UInt16>(channel << shift);
+            }
+
+            output[x] = result;
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    SoftwareRenderer::SoftwareRenderer(Int32 width, Int32 height)
+        : m_BgColors(256, 0),
+          m_ObjColors(256, 0),
+          m_Width(width),
+          m_Height(height),
+          m_Mode(BM_None),
+          m_First(0),
+          m_Second(0),
+          m_Eva(16),
+          m_Evb(0),
+          m_Evy(0)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            Background &bg = m_Backgrounds[i];
+            bg.width = 0;
+            bg.height = 0;
+            bg.scrollX = 0;
+            bg.scrollY = 0;
+            bg.priority = i;
+            bg.mask = 0xFF;
+            bg.enabled = false;
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Member functions
+    //
+    ///////////////////////////////////////////////////////////
+    const QString &SoftwareRenderer::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool SoftwareRenderer::setBackgroundPalettes(const QList<const Palette *> &palettes)
+    {
+        if (!render_palettes(palettes, &m_BgColors))
+        {
+            m_LastError = RDR_ERROR_PALETTES;
+            return false;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool SoftwareRenderer::setSpritePalettes(const QList<const Palette *> &palettes)
+    {
+        if (!render_palettes(palettes, &m_ObjColors))
+        {
+            m_LastError = RDR_ERROR_PALETTES;
+            return false;
+        }
+
+        return true;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setBackground(Int32 layer, const Tilemap &map, const Image &tiles, Boolean is4bpp)
+    {
+        Q_ASSERT(layer >= 0 && layer < 4);
+        Background &bg = m_Backgrounds[layer];
+
+        // 4bpp indices hold the bank in their upper bits, which
+        // must not be taken into account for transparency.
+        bg.indices = map.composeIndexed(tiles, is4bpp);
+        bg.width = map.size().width() * 8;
+        bg.height = map.size().height() * 8;
+        bg.mask = is4bpp ? 0x0F : 0xFF;
+        bg.enabled = (bg.width > 0 && bg.height > 0);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setBackgroundEnabled(Int32 layer, Boolean enabled)
+    {
+        Q_ASSERT(layer >= 0 && layer < 4);
+        Background &bg = m_Backgrounds[layer];
+        bg.enabled = enabled && bg.width > 0 && bg.height > 0;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setBackgroundPriority(Int32 layer, Int32 priority)
+    {
+        Q_ASSERT(layer >= 0 && layer < 4);
+        m_Backgrounds[layer].priority = priority & 3;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setBackgroundScroll(Int32 layer, Int32 x, Int32 y)
+    {
+        Q_ASSERT(layer >= 0 && layer < 4);
+        m_Backgrounds[layer].scrollX = x;
+        m_Backgrounds[layer].scrollY = y;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setSprites(const QVector<RenderSprite> &sprites)
+    {
+        m_Sprites.clear();
+        m_SpritePixels.clear();
+
+        // Copies the pixels, already merged with their bank
+        foreach (const RenderSprite &sprite, sprites)
+        {
+            if (sprite.image == NULL)
+                continue;
+
+            Sprite copy;
+            copy.offset = m_SpritePixels.size();
+            copy.x = sprite.x;
+            copy.y = sprite.y;
+            copy.width = sprite.image->size().width();
+            copy.height = sprite.image->size().height();
+            copy.priority = sprite.priority & 3;
+            copy.semiTransparent = sprite.semiTransparent;
+
+            m_SpritePixels.resize(copy.offset + copy.width * copy.height);
+            UInt8 *pixels = reinterpret_cast<UInt8 *>(m_SpritePixels.data()) + copy.offset;
+            UInt8 bank = static_cast<UInt8>(sprite.is4bpp ? (sprite.bank & 0xF) << 4 : 0);
+
+            for (int y = 0; y < copy.height; y++)
+            {
+                for (int x = 0; x < copy.width; x++)
+                {
+                    UInt8 index = sprite.image->pixel(
+                        sprite.hflip ? copy.width - 1 - x : x,
+                        sprite.vflip ? copy.height - 1 - y : y);
+
+                    if (sprite.is4bpp)
+                        index &= 0x0F;
+
+                    *pixels++ = (index != 0) ? (index | bank) : 0;
+                }
+            }
+
+            m_Sprites.push_back(copy);
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::setBlending(BlendMode mode, Int32 first, Int32 second, Int32 eva, Int32 evb, Int32 evy)
+    {
+        m_Mode = mode;
+        m_First = first;
+        m_Second = second;
+        m_Eva = qMin(eva, 16);
+        m_Evb = qMin(evb, 16);
+        m_Evy = qMin(evy, 16);
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QSize SoftwareRenderer::size() const
+    {
+        return QSize(m_Width, m_Height);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QVector<Color> SoftwareRenderer::render() const
+    {
+        QVector<Color> output(m_Width * m_Height);
+        render(output.data());
+        return output;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::render(Color *output) const
+    {
+        // Splits the frame into bands of scanlines
+        parallel_bands(m_Height, PARALLEL_BAND_LINES, [=](Int32 first, Int32 last)
+        {
+            renderLines(first, last - first, output);
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void SoftwareRenderer::renderLines(Int32 first, Int32 count, Color *output) const
+    {
+        QVector<UInt8> objIndices(m_Width);
+        QVector<UInt8> objPriority(m_Width);
+        QVector<UInt8> objSemi(m_Width);
+        QVector<UInt16> top(m_Width);
+        QVector<UInt16> bottom(m_Width);
+        QVector<UInt8> modes(m_Width);
+        QVector<UInt16> result(m_Width);
+        QByteArray bgLines(m_Width * 4, '\0');
+        const UInt16 *bgColors = m_BgColors.constData();
+        const UInt16 *objColors = m_ObjColors.constData();
+
+        // Orders the enabled backgrounds by priority, then number
+        Int32 order[4];
+        Int32 layers = 0;
+        for (int priority = 0; priority < 4; priority++)
+            for (int i = 0; i < 4; i++)
+                if (m_Backgrounds[i].enabled && m_Backgrounds[i].priority == priority)
+                    order[layers++] = i;
+
+
+        for (Int32 line = first; line < first + count; line++)
+        {
+            // Draws the sprites that cover this scanline
+            std::memset(objIndices.data(), 0, m_Width);
+            std::memset(objPriority.data(), RENDERER_NO_PRIORITY, m_Width);
+            std::memset(objSemi.data(), 0, m_Width);
+
+            const UInt8 *spritePixels = reinterpret_cast<const UInt8 *>(m_SpritePixels.constData());
+            for (int i = 0; i < m_Sprites.size(); i++)
+            {
+                const Sprite &sprite = m_Sprites.at(i);
+                if (line < sprite.y || line >= sprite.y + sprite.height)
+                    continue;
+
+                const UInt8 *row = spritePixels + sprite.offset + (line - sprite.y) * sprite.width;
+                Int32 left = qMax(0, sprite.x);
+                Int32 right = qMin(m_Width, sprite.x + sprite.width);
+
+                for (Int32 x = left; x < right; x++)
+                {
+                    UInt8 index = row[x - sprite.x];
+                    if (index != 0 && sprite.priority < objPriority[x])
+                    {
+                        objIndices[x] = index;
+                        objPriority[x] = static_cast<UInt8>(sprite.priority);
+                        objSemi[x] = sprite.semiTransparent;
+                    }
+                }
+            }
+
+            // Copies the visible part of each background, wrapping
+            // around at the edges of the tilemap.
+            const UInt8 *bgRows[4];
+            for (int i = 0; i < layers; i++)
+            {
+                const Background &bg = m_Backgrounds[order[i]];
+                Int32 y = ((line + bg.scrollY) % bg.height + bg.height) % bg.height;
+                Int32 x = ((bg.scrollX % bg.width) + bg.width) % bg.width;
+                const UInt8 *row = reinterpret_cast<const UInt8 *>(bg.indices.constData()) + y * bg.width;
+                UInt8 *target = reinterpret_cast<UInt8 *>(bgLines.data()) + i * m_Width;
+
+                for (Int32 copied = 0; copied < m_Width; )
+                {
+                    Int32 amount = qMin(bg.width - x, m_Width - copied);
+                    std::memcpy(target + copied, row + x, amount);
+                    copied += amount;
+                    x = 0;
+                }
+
+                bgRows[i] = target;
+            }
+
+
+            // Determines the two topmost layers of each pixel
+            for (Int32 x = 0; x < m_Width; x++)
+            {
+                UInt16 colors[2] = { bgColors[0], bgColors[0] };
+                Int32 targets[2] = { RENDERER_LAYER_BD, RENDERER_LAYER_BD };
+                Int32 found = 0;
+                Int32 layer = 0;
+
+                for (int priority = 0; priority < 4 && found < 2; priority++)
+                {
+                    if (objPriority[x] == priority)
+                    {
+                        colors[found] = objColors[objIndices[x]];
+                        targets[found++] = RENDERER_LAYER_OBJ;
+                    }
+
+                    for (; layer < layers && found < 2; layer++)
+                    {
+                        const Background &bg = m_Backgrounds[order[layer]];
+                        if (bg.priority != priority)
+                            break;
+
+                        UInt8 index = bgRows[layer][x];
+                        if ((index & bg.mask) != 0)
+                        {
+                            colors[found] = bgColors[index];
+                            targets[found++] = order[layer];
+                        }
+                    }
+                }
+
+                top[x] = colors[0];
+                bottom[x] = colors[1];
+
+
+                // Semi-transparent sprites blend regardless of the mode
+                Boolean isFirst = (m_First & (1 << targets[0])) != 0;
+                Boolean isSecond = (m_Second & (1 << targets[1])) != 0;
+                UInt8 mode = BM_None;
+
+                if (targets[0] == RENDERER_LAYER_OBJ && objSemi[x] && isSecond)
+                    mode = BM_Alpha;
+                else if (m_Mode == BM_Alpha)
+                    mode = (isFirst && isSecond) ? BM_Alpha : BM_None;
+                else if (isFirst)
+                    mode = static_cast<UInt8>(m_Mode);
+
+                modes[x] = mode;
+            }
+
+            render_blend(top.constData(), bottom.constData(), modes.constData(),
+                         m_Width, m_Eva, m_Evb, m_Evy, result.data());
+            ColorCodec::decode(result.constData(), m_Width, output + line * m_Width);
+        }
+    }
+}
@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Lz77.hpp>
+#include <QBoy/Graphics/ImageErrors.hpp>
+#include <QBoy/Graphics/SpriteSheet.hpp>
+#include <QBoy/Graphics/TileCodec.hpp>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Sprite definitions
+    //
+    ///////////////////////////////////////////////////////////
+    const Int32 sprite_sizes[3][4][2] =
+    {
+        { {  8,  8 }, { 16, 16 }, { 32, 32 }, { 64, 64 } },
+        { { 16,  8 }, { 32,  8 }, { 32, 16 }, { 64, 32 } },
+        { {  8, 16 }, {  8, 32 }, { 16, 32 }, { 32, 64 } }
+    };
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    SpriteSheet::SpriteSheet()
+        : m_Width(0),
+          m_Height(0),
+          m_Count(0)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &SpriteSheet::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool SpriteSheet::readUncompressed(
+            const Rom &rom,
+            UInt32 offset,
+            SpriteShape shape,
+            Int32 size,
+            Int32 frames,
+            Boolean is4bpp)
+    {
+        QSize dimension = frameSize(shape, size);
+        Int32 length = dimension.width() * dimension.height() * frames / (is4bpp ? 2 : 1);
+
+        // Attempts to seek to the given offset
+        if (!rom.seek(offset) || !rom.canRead(length))
+        {
+            m_LastError = IMG_ERROR_OFFSET;
+            return false;
+        }
+
+        QByteArray data = rom.readBytes(length);
+        return convertFromGBA(reinterpret_cast<const UInt8 *>(data.constData()), length, shape, size, is4bpp);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool SpriteSheet::readCompressed(
+            const Rom &rom,
+            UInt32 offset,
+            SpriteShape shape,
+            Int32 size,
+            Boolean is4bpp)
+    {
+        // Determines whether the given offset is valid
+        if (!rom.checkOffset(offset))
+        {
+            m_LastError = IMG_ERROR_OFFSET;
+            return false;
+        }
+
+        // Attempts to decompress the LZ77 data
+        Int32 compressed = 0;
+        QByteArray data = Lz77::decompress(rom, offset, &compressed);
+        if (data.isNull())
+        {
+            m_LastError = IMG_ERROR_LZ77;
+            return false;
+        }
+
+        return convertFromGBA(reinterpret_cast<const UInt8 *>(data.constData()), data.size(), shape, size, is4bpp);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool SpriteSheet::convertFromGBA(const UInt8 *data, Int32 length, SpriteShape shape, Int32 size, Boolean is4bpp)
+    {
+        QSize dimension = frameSize(shape, size);
+        Int32 frameLength = dimension.width() * dimension.height() / (is4bpp ? 2 : 1);
+
+        if (frameLength == 0 || length < frameLength)
+        {
+            m_LastError = IMG_ERROR_FRAMES;
+            return false;
+        }
+
+
+        m_Width = dimension.width();
+        m_Height = dimension.height();
+        m_Count = length / frameLength;
+        m_Frames.resize(m_Width * m_Height * m_Count);
+
+        // With 1D mapping, the frames stacked on top of each other
+        // form one image whose tiles are just the tile data.
+        UInt8 *output = reinterpret_cast<UInt8 *>(m_Frames.data());
+        if (is4bpp)
+            TileCodec::decode4bpp(data, m_Count * frameLength, m_Width, m_Height * m_Count, output);
+        else
+            TileCodec::decode8bpp(data, m_Count * frameLength, m_Width, m_Height * m_Count, output);
+
+        return true;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QSize SpriteSheet::frameSize(SpriteShape shape, Int32 size)
+    {
+        if (shape < SS_Square || shape > SS_Vertical || size < 0 || size > 3)
+            return QSize(0, 0);
+
+        return QSize(sprite_sizes[shape][size][0], sprite_sizes[shape][size][1]);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QSize SpriteSheet::frameSize() const
+    {
+        return QSize(m_Width, m_Height);
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 SpriteSheet::frameCount() const
+    {
+        return m_Count;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QByteArray &SpriteSheet::raw() const
+    {
+        return m_Frames;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const UInt8 *SpriteSheet::frame(Int32 index) const
+    {
+        Q_ASSERT(index >= 0 && index < m_Count);
+        return reinterpret_cast<const UInt8 *>(m_Frames.constData()) + index * m_Width * m_Height;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Image SpriteSheet::image(Int32 index) const
+    {
+        Image image;
+        image.setSize(m_Width, m_Height);
+        image.setRaw(QByteArray(reinterpret_cast<const char *>(frame(index)), m_Width * m_Height));
+        return image;
+    }
+}
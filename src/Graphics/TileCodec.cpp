@@ -0,0 +1,318 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/TileCodec.hpp>
+#include <QVector>
+#include <cstring>
+#include "Parallel.hpp"
+#ifdef QBOY_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    /// Expands one complete 4bpp tile (32 bytes) to 64 indices.
+    /// The low nibble of each byte is the left pixel.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_decode4(const UInt8 *tile, UInt8 *output, Int32 stride)
+    {
+    #ifdef QBOY_SSE2
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        for (int half = 0; half < 2; half++)
+        {
+            // Four rows of four bytes each
+            __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tile + half * 16));
+            __m128i lo = _mm_and_si128(packed, mask);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+
+            // Interleaving yields two rows of eight pixels each
+            __m128i rows01 = _mm_unpacklo_epi8(lo, hi);
+            __m128i rows23 = _mm_unpackhi_epi8(lo, hi);
+
+            UInt8 *row = output + half * 4 * stride;
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(row + 0 * stride), rows01);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(row + 1 * stride), _mm_srli_si128(rows01, 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(row + 2 * stride), rows23);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(row + 3 * stride), _mm_srli_si128(rows23, 8));
+        }
+    #else
+        for (int y = 0; y < 8; y++)
+        {
+            UInt8 *row = output + y * stride;
+            for (int x = 0; x < 4; x++)
+            {
+                UInt8 nibbles = tile[y * 4 + x];
+                row[x * 2 + 0] = nibbles & 0x0F;
+                row[x * 2 + 1] = nibbles >> 4;
+            }
+        }
+    #endif
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Expands an incomplete 4bpp tile; missing pixels are zero.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_decode4_partial(const UInt8 *tile, Int32 bytes, UInt8 *output, Int32 stride)
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            UInt8 *row = output + y * stride;
+            for (int x = 0; x < 4; x++)
+            {
+                Int32 index = y * 4 + x;
+                UInt8 nibbles = (index < bytes) ? tile[index] : 0;
+                row[x * 2 + 0] = nibbles & 0x0F;
+                row[x * 2 + 1] = nibbles >> 4;
+            }
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    /// Expands one complete 8bpp tile (64 bytes) to 64 indices.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_decode8(const UInt8 *tile, UInt8 *output, Int32 stride)
+    {
+    #ifdef QBOY_SSE2
+        for (int y = 0; y < 8; y += 2)
+        {
+            __m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tile + y * 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + (y + 0) * stride), rows);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + (y + 1) * stride), _mm_srli_si128(rows, 8));
+        }
+    #else
+        for (int y = 0; y < 8; y++)
+            std::memcpy(output + y * stride, tile + y * 8, 8);
+    #endif
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Gathers the 64 indices of one tile into 8bpp tile data.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_encode8(const UInt8 *input, Int32 stride, UInt8 *tile)
+    {
+    #ifdef QBOY_SSE2
+        for (int y = 0; y < 8; y += 2)
+        {
+            __m128i row0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + (y + 0) * stride));
+            __m128i row1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + (y + 1) * stride));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(tile + y * 8), _mm_unpacklo_epi64(row0, row1));
+        }
+    #else
+        for (int y = 0; y < 8; y++)
+            std::memcpy(tile + y * 8, input + y * stride, 8);
+    #endif
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Packs the 64 indices of one tile into 4bpp tile data.
+    /// The left pixel goes into the low nibble of each byte.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_encode4(const UInt8 *input, Int32 stride, UInt8 *tile)
+    {
+    #ifdef QBOY_SSE2
+        const __m128i mask = _mm_set1_epi16(0x000F);
+        for (int half = 0; half < 2; half++)
+        {
+            const UInt8 *row = input + half * 4 * stride;
+            __m128i rows01 = _mm_unpacklo_epi64(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + 0 * stride)),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + 1 * stride)));
+            __m128i rows23 = _mm_unpacklo_epi64(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + 2 * stride)),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + 3 * stride)));
+
+            // Each 16-bit lane holds a pixel pair; the right pixel is
+            // moved next to the left one and the lanes are narrowed.
+            __m128i pairs01 = _mm_or_si128(_mm_and_si128(rows01, mask), _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(rows01, 8), mask), 4));
+            __m128i pairs23 = _mm_or_si128(_mm_and_si128(rows23, mask), _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(rows23, 8), mask), 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(tile + half * 16), _mm_packus_epi16(pairs01, pairs23));
+        }
+    #else
+        for (int y = 0; y < 8; y++)
+        {
+            const UInt8 *row = input + y * stride;
+            for (int x = 0; x < 4; x++)
+                tile[y * 4 + x] = (UInt8)((row[x * 2 + 0] & 0x0F) | ((row[x * 2 + 1] & 0x0F) << 4));
+        }
+    #endif
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decodeTile4bpp(const UInt8 *tile, UInt8 *output, Int32 stride)
+    {
+        tile_decode4(tile, output, stride);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decodeTile8bpp(const UInt8 *tile, UInt8 *output, Int32 stride)
+    {
+        tile_decode8(tile, output, stride);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decode4bpp(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+
+        // Decodes one row of tiles at a time; each row covers eight
+        // consecutive lines of the output.
+        parallel_rows(rows, columns, [data, length, width, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+            {
+                Int32 source = (row * columns + column) * 32;
+                UInt8 *target = output + row * 8 * width + column * 8;
+
+                if (source + 32 <= length)
+                    tile_decode4(data + source, target, width);
+                else if (source < length)
+                    tile_decode4_partial(data + source, length - source, target, width);
+                else
+                    for (int y = 0; y < 8; y++)
+                        std::memset(target + y * width, 0, 8);
+            }
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decodeTile4bppPacked(const UInt8 *tile, UInt8 *output, Int32 stride)
+    {
+        // Every row of a 4bpp tile already has the packed layout
+        for (int y = 0; y < 8; y++)
+            std::memcpy(output + y * stride, tile + y * 4, 4);
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decode4bppPacked(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+        Int32 stride = width / 2;
+
+        parallel_rows(rows, columns, [data, length, stride, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+            {
+                Int32 source = (row * columns + column) * 32;
+                UInt8 *target = output + row * 8 * stride + column * 4;
+
+                if (source + 32 <= length)
+                {
+                    decodeTile4bppPacked(data + source, target, stride);
+                }
+                else
+                {
+                    // Copies what is left of the data; the rest is zero
+                    for (int i = 0; i < 32; i++)
+                        target[(i / 4) * stride + (i % 4)] = (source + i < length) ? data[source + i] : 0;
+                }
+            }
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::encode4bppPacked(const UInt8 *input, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+        Int32 stride = width / 2;
+
+        parallel_rows(rows, columns, [input, stride, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+            {
+                const UInt8 *source = input + row * 8 * stride + column * 4;
+                UInt8 *tile = output + (row * columns + column) * 32;
+                for (int y = 0; y < 8; y++)
+                    std::memcpy(tile + y * 4, source + y * stride, 4);
+            }
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::decode8bpp(const UInt8 *data, Int32 length, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+
+        parallel_rows(rows, columns, [data, length, width, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+            {
+                Int32 source = (row * columns + column) * 64;
+                UInt8 *target = output + row * 8 * width + column * 8;
+
+                if (source + 64 <= length)
+                {
+                    tile_decode8(data + source, target, width);
+                }
+                else
+                {
+                    // Copies what is left of the data; the rest is zero
+                    for (int i = 0; i < 64; i++)
+                        target[(i / 8) * width + (i % 8)] = (source + i < length) ? data[source + i] : 0;
+                }
+            }
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::encode4bpp(const UInt8 *input, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+
+        parallel_rows(rows, columns, [input, width, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+                tile_encode4(input + row * 8 * width + column * 8, width, output + (row * columns + column) * 32);
+        });
+    }
+
+    ///////////////////////////////////////////////////////////
+    void TileCodec::encode8bpp(const UInt8 *input, Int32 width, Int32 height, UInt8 *output)
+    {
+        Int32 columns = width / 8;
+        Int32 rows = height / 8;
+
+        parallel_rows(rows, columns, [input, width, columns, output](Int32 row)
+        {
+            for (Int32 column = 0; column < columns; column++)
+                tile_encode8(input + row * 8 * width + column * 8, width, output + (row * columns + column) * 64);
+        });
+    }
+}
@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Lz77.hpp>
+#include <QBoy/Graphics/Tilemap.hpp>
+#include <QBoy/Graphics/TilemapErrors.hpp>
+#include <cstring>
+#include "Parallel.hpp"
+#ifdef QBOY_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Tilemap definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define TILEMAP_BLOCK_SIZE          32
+
+
+    ///////////////////////////////////////////////////////////
+    /// Gathers the tiles of an image into 64 indices per tile,
+    /// followed by one empty tile for invalid tile numbers.
+    ///
+    ///////////////////////////////////////////////////////////
+    QByteArray map_gather(const Image &image, Int32 *count)
+    {
+        Int32 columns = image.size().width() / 8;
+        Int32 rows = image.size().height() / 8;
+        QByteArray tiles(columns * rows * 64 + 64, '\0');
+        UInt8 *output = reinterpret_cast<UInt8 *>(tiles.data());
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(image.raw().constData());
+        Int32 width = image.size().width();
+
+        for (Int32 tile = 0; tile < columns * rows; tile++)
+        {
+            Int32 left = (tile % columns) * 8;
+            Int32 top = (tile / columns) * 8;
+
+            for (int y = 0; y < 8; y++)
+            {
+                UInt8 *row = output + tile * 64 + y * 8;
+                if (image.isPacked())
+                {
+                    for (int x = 0; x < 8; x++)
+                        row[x] = image.pixel(left + x, top + y);
+                }
+                else
+                {
+                    std::memcpy(row, input + (top + y) * width + left, 8);
+                }
+            }
+        }
+
+        *count = columns * rows;
+        return tiles;
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Draws one tile of the map, applying the flip flags and
+    /// merging the bank into the indices.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void map_tile(const UInt8 *tile, UInt16 entry, UInt8 bank, UInt8 *output, Int32 stride)
+    {
+        Boolean hflip = (entry & TE_HFlip) != 0;
+        Boolean vflip = (entry & TE_VFlip) != 0;
+
+    #ifdef QBOY_SSE2
+        const __m128i merge = _mm_set1_epi8(static_cast<char>(bank));
+        for (int y = 0; y < 8; y += 2)
+        {
+            // Two rows at once; a vertical flip swaps them afterwards
+            __m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tile + (vflip ? 6 - y : y) * 8));
+            if (vflip)
+                rows = _mm_shuffle_epi32(rows, _MM_SHUFFLE(1, 0, 3, 2));
+
+            // Swaps the bytes of each word, then reverses the words
+            if (hflip)
+            {
+                rows = _mm_or_si128(_mm_slli_epi16(rows, 8), _mm_srli_epi16(rows, 8));
+                rows = _mm_shufflelo_epi16(rows, _MM_SHUFFLE(0, 1, 2, 3));
+                rows = _mm_shufflehi_epi16(rows, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+
+            rows = _mm_or_si128(rows, merge);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + (y + 0) * stride), rows);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + (y + 1) * stride), _mm_srli_si128(rows, 8));
+        }
+    #else
+        for (int y = 0; y < 8; y++)
+        {
+            const UInt8 *row = tile + (vflip ? 7 - y : y) * 8;
+            UInt8 *target = output + y * stride;
+
+            for (int x = 0; x < 8; x++)
+                target[x] = row[hflip ? 7 - x : x] | bank;
+        }
+    #endif
+    }
+
+    ///////////////////////////////////////////////////////////
+    /// Draws one row of tiles into the given indices.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void map_row(
+            const UInt16 *entries,
+            Int32 columns,
+            const UInt8 *tiles,
+            Int32 count,
+            Boolean is4bpp,
+            UInt8 *output)
+    {
+        Int32 stride = columns * 8;
+        for (Int32 column = 0; column < columns; column++)
+        {
+            UInt16 entry = entries[column];
+            Int32 number = entry & TE_IndexMask;
+            UInt8 bank = is4bpp ? static_cast<UInt8>((entry & TE_PaletteMask) >> 8) : 0;
+
+            if (number >= count)
+            {
+                number = count;
+                bank = 0;
+            }
+
+            map_tile(tiles + number * 64, entry, bank, output + column * 8, stride);
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    Tilemap::Tilemap()
+        : m_Width(0),
+          m_Height(0)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QString &Tilemap::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool Tilemap::readUncompressed(const Rom &rom, UInt32 offset, Int32 width, Int32 height, Boolean blocks)
+    {
+        // Attempts to seek to the given offset
+        if (!rom.seek(offset) || !rom.canRead(width * height * 2))
+        {
+            m_LastError = MAP_ERROR_OFFSET;
+            return false;
+        }
+
+        return convertGBA(rom.readHWordTable(width * height), width, blocks);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Tilemap::readCompressed(const Rom &rom, UInt32 offset, Int32 width, Boolean blocks)
+    {
+        // Determines whether the given offset is valid
+        if (!rom.checkOffset(offset))
+        {
+            m_LastError = MAP_ERROR_OFFSET;
+            return false;
+        }
+
+        // Attempts to decompress the LZ77 data
+        Int32 size = 0;
+        QByteArray data = Lz77::decompress(rom, offset, &size);
+        if (data.isNull())
+        {
+            m_LastError = MAP_ERROR_LZ77;
+            return false;
+        }
+
+
+        // Converts the byte data to half-word data
+        QList<UInt16> entries;
+        entries.reserve(data.size() / 2);
+
+        for (int i = 0; i < data.size() / 2; i++)
+        {
+            UInt8 low = data.at(i*2);
+            UInt8 high = data.at(i*2+1);
+            entries.push_back(static_cast<UInt16>((high << 8) | low));
+        }
+
+        return convertGBA(entries, width, blocks);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Tilemap::convertGBA(const QList<UInt16> &entries, Int32 width, Boolean blocks)
+    {
+        if (width <= 0 || entries.size() % width != 0)
+        {
+            m_LastError = MAP_ERROR_SIZE;
+            return false;
+        }
+
+        Int32 height = entries.size() / width;
+        if (blocks && (width % TILEMAP_BLOCK_SIZE != 0 || height % TILEMAP_BLOCK_SIZE != 0))
+        {
+            m_LastError = MAP_ERROR_SIZE;
+            return false;
+        }
+
+
+        m_Width = width;
+        m_Height = height;
+        m_Entries.resize(entries.size());
+
+        // Blocks of 32x32 entries follow each other row by row
+        Int32 blocksPerRow = width / TILEMAP_BLOCK_SIZE;
+        for (int i = 0; i < entries.size(); i++)
+        {
+            Int32 target = i;
+            if (blocks)
+            {
+                Int32 block = i / (TILEMAP_BLOCK_SIZE * TILEMAP_BLOCK_SIZE);
+                Int32 inner = i % (TILEMAP_BLOCK_SIZE * TILEMAP_BLOCK_SIZE);
+                Int32 x = (block % blocksPerRow) * TILEMAP_BLOCK_SIZE + inner % TILEMAP_BLOCK_SIZE;
+                Int32 y = (block / blocksPerRow) * TILEMAP_BLOCK_SIZE + inner / TILEMAP_BLOCK_SIZE;
+                target = y * width + x;
+            }
+
+            m_Entries[target] = entries.at(i);
+        }
+
+        return true;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QVector<UInt16> &Tilemap::entries() const
+    {
+        return m_Entries;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QSize Tilemap::size() const
+    {
+        return QSize(m_Width, m_Height);
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool Tilemap::setEntries(const QVector<UInt16> &entries, Int32 width)
+    {
+        if (width <= 0 || entries.size() % width != 0)
+        {
+            m_LastError = MAP_ERROR_SIZE;
+            return false;
+        }
+
+        m_Entries = entries;
+        m_Width = width;
+        m_Height = entries.size() / width;
+        return true;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Tilemap::composeIndexed(const Image &tiles, Boolean is4bpp) const
+    {
+        Int32 count = 0;
+        QByteArray source = map_gather(tiles, &count);
+        QByteArray output(m_Width * m_Height * 64, '\0');
+
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(source.constData());
+        const UInt16 *entries = m_Entries.constData();
+        UInt8 *pixels = reinterpret_cast<UInt8 *>(output.data());
+        Int32 width = m_Width;
+
+        parallel_rows(m_Height, m_Width, [=](Int32 row)
+        {
+            map_row(entries + row * width, width, input, count, is4bpp, pixels + row * width * 64);
+        });
+
+        return output;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QVector<Color> Tilemap::compose(const Image &tiles, const QList<const Palette *> &palettes, Boolean is4bpp) const
+    {
+        // Flattens the palettes to one table of 256 colors
+        Color lookup[256];
+        std::memset(lookup, 0, sizeof(lookup));
+
+        for (int i = 0; i < palettes.size() && (is4bpp ? i < 16 : i < 1); i++)
+        {
+            if (palettes.at(i) == NULL)
+                continue;
+
+            const QVector<Color> &colors = palettes.at(i)->raw();
+            Int32 first = is4bpp ? i * 16 : 0;
+            Int32 amount = qMin(colors.size(), is4bpp ? 16 : 256);
+            for (int j = 0; j < amount; j++)
+                lookup[first + j] = colors.at(j);
+        }
+
+
+        Int32 count = 0;
+        QByteArray source = map_gather(tiles, &count);
+        QVector<Color> output(m_Width * m_Height * 64);
+
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(source.constData());
+        const UInt16 *entries = m_Entries.constData();
+        const Color *table = lookup;
+        Color *colors = output.data();
+        Int32 width = m_Width;
+
+        // Each row of tiles is drawn to indices, which are then
+        // looked up while they are still in the cache.
+        parallel_rows(m_Height, m_Width, [=](Int32 row)
+        {
+            QByteArray indices(width * 64, '\0');
+            UInt8 *pixels = reinterpret_cast<UInt8 *>(indices.data());
+            map_row(entries + row * width, width, input, count, is4bpp, pixels);
+
+            Color *target = colors + row * width * 64;
+            for (int i = 0; i < width * 64; i++)
+                target[i] = table[pixels[i]];
+        });
+
+        return output;
+    }
+}
@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/Tileset.hpp>
+#include <QBoy/Graphics/ImageErrors.hpp>
+#include <QBoy/Graphics/TileCodec.hpp>
+#include <QHash>
+#include <QPair>
+#include <cstring>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Tileset definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define TILESET_MAX_TILES   1024
+
+
+    ///////////////////////////////////////////////////////////
+    /// Creates the mirrored version of a tile. Bit 0 of flip
+    /// mirrors horizontally, bit 1 vertically.
+    ///
+    ///////////////////////////////////////////////////////////
+    inline void tile_flip(const UInt8 *tile, Int32 flip, UInt8 *output)
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            const UInt8 *row = tile + ((flip & 2) ? 7 - y : y) * 8;
+            UInt8 *target = output + y * 8;
+
+            if (flip & 1)
+                for (int x = 0; x < 8; x++)
+                    target[x] = row[7 - x];
+            else
+                std::memcpy(target, row, 8);
+        }
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor
+    //
+    ///////////////////////////////////////////////////////////
+    Tileset::Tileset()
+        : m_Columns(0),
+          m_Rows(0)
+    {
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    bool Tileset::fromImage(const Image &image, Boolean detectFlips)
+    {
+        m_Columns = image.size().width() / 8;
+        m_Rows = image.size().height() / 8;
+        m_Tiles.clear();
+        m_Entries.clear();
+        m_Entries.reserve(m_Columns * m_Rows);
+
+        // Maps the canonical form of each unique tile to its number
+        // and to the flip which turns the stored tile into that form.
+        QHash<QByteArray, QPair<Int32, Int32>> known;
+        UInt8 tile[64];
+        UInt8 variants[4][64];
+        Int32 flips = detectFlips ? 4 : 1;
+
+
+        for (Int32 row = 0; row < m_Rows; row++)
+        {
+            for (Int32 column = 0; column < m_Columns; column++)
+            {
+                // Gathers the pixels of the tile
+                for (int y = 0; y < 8; y++)
+                    for (int x = 0; x < 8; x++)
+                        tile[y * 8 + x] = image.pixel(column * 8 + x, row * 8 + y);
+
+                // The smallest of all mirrored versions is the same
+                // for a tile and each of its flipped copies.
+                Int32 canonical = 0;
+                for (Int32 flip = 0; flip < flips; flip++)
+                {
+                    tile_flip(tile, flip, variants[flip]);
+                    if (std::memcmp(variants[flip], variants[canonical], 64) < 0)
+                        canonical = flip;
+                }
+
+                QByteArray key(reinterpret_cast<const char *>(variants[canonical]), 64);
+                QHash<QByteArray, QPair<Int32, Int32>>::const_iterator it = known.constFind(key);
+                if (it != known.constEnd())
+                {
+                    // Flipping the stored tile into the canonical form and
+                    // back out of it by this tile's flip yields this tile.
+                    Int32 flip = it.value().second ^ canonical;
+                    m_Entries.push_back((UInt16)(it.value().first |
+                        ((flip & 1) ? TE_HFlip : 0) |
+                        ((flip & 2) ? TE_VFlip : 0)));
+                }
+                else
+                {
+                    Int32 number = m_Tiles.size() / 64;
+                    if (number == TILESET_MAX_TILES)
+                    {
+                        m_LastError = IMG_ERROR_TILES;
+                        return false;
+                    }
+
+                    known.insert(key, qMakePair(number, canonical));
+                    m_Tiles.append(reinterpret_cast<const char *>(tile), 64);
+                    m_Entries.push_back((UInt16)number);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QString &Tileset::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    Int32 Tileset::count() const
+    {
+        return m_Tiles.size() / 64;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QByteArray &Tileset::tiles() const
+    {
+        return m_Tiles;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QVector<UInt16> &Tileset::entries() const
+    {
+        return m_Entries;
+    }
+
+    ///////////////////////////////////////////////////////////
+    QSize Tileset::mapSize() const
+    {
+        return QSize(m_Columns, m_Rows);
+    }
+
+    ///////////////////////////////////////////////////////////
+    QByteArray Tileset::toGBA(Boolean is4bpp) const
+    {
+        // The tiles form an image of eight pixels in width, whose
+        // rows of tiles are just the tiles in order.
+        QByteArray data;
+        data.resize(is4bpp ? m_Tiles.size() / 2 : m_Tiles.size());
+        const UInt8 *input = reinterpret_cast<const UInt8 *>(m_Tiles.constData());
+        UInt8 *output = reinterpret_cast<UInt8 *>(data.data());
+
+        if (is4bpp)
+            TileCodec::encode4bpp(input, 8, count() * 8, output);
+        else
+            TileCodec::encode8bpp(input, 8, count() * 8, output);
+
+        return data;
+    }
+}
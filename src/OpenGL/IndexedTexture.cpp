@@ -26,6 +26,7 @@
 ///////////////////////////////////////////////////////////
 #include <QBoy/OpenGL/GLErrors.hpp>
 #include <QBoy/OpenGL/IndexedTexture.hpp>
+#include <algorithm>
 
 
 namespace qboy
@@ -52,11 +53,13 @@ namespace qboy
     IndexedTexture::IndexedTexture()
         : m_Width(0),
           m_Height(0),
+          m_IsPacked(false),
           m_PaletteID(0),
           m_TextureID(0),
           m_VertexBuffer(0),
           m_IndexBuffer(0),
-          m_Colors(0),
+          m_Bank(0),
+          m_PaletteOffset(0),
           m_Pixels(0)
     {
     }
@@ -70,8 +73,7 @@ namespace qboy
         glCheck(m_Functions->glDeleteBuffers(1, &m_VertexBuffer));
         glCheck(m_Functions->glDeleteBuffers(1, &m_IndexBuffer));
 
-        // Frees the pixel and color data
-        delete m_Colors;
+        // Frees the pixel data
         delete m_Pixels;
     }
 
@@ -80,29 +82,45 @@ namespace qboy
     // Setters
     //
     ///////////////////////////////////////////////////////////
-    void IndexedTexture::setPalette(GLColor *palette)
+    void IndexedTexture::setPalette(const GLColor *palette, Int32 count)
     {
-        m_Colors = palette;
+        // Copies the colors; palettes share their OpenGL data
+        count = qBound(0, count, 256);
+        GLColor none = { 0.0f, 0.0f, 0.0f, 0.0f };
+        m_Colors.fill(none, 256);
+        std::copy(palette, palette + count, m_Colors.begin());
+        m_Bank = 0;
+        m_PaletteOffset = 0;
 
         // Fills the OpenGL palette texture with data
         glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_PaletteID));
-        glCheck(m_Functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_FLOAT, palette));
+        glCheck(m_Functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_FLOAT, m_Colors.constData()));
     }
 
     ///////////////////////////////////////////////////////////
-    void IndexedTexture::setImage(UInt8 *pixels, Int32 width, Int32 height)
+    void IndexedTexture::setPalette(PaletteBank *bank, Int32 offset)
+    {
+        m_Bank = bank;
+        m_PaletteOffset = offset;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void IndexedTexture::setImage(UInt8 *pixels, Int32 width, Int32 height, Boolean packed)
     {
         m_Width = width;
         m_Height = height;
+        m_IsPacked = packed;
         m_Pixels = pixels;
 
         // Converts the width and height to float for OpenGL
         float ogl_w = (float)width;
         float ogl_h = (float)height;
 
-        // Allocates space with initial texture data
+        // Allocates space with initial texture data. Packed
+        // data occupies one texel per two pixels.
+        Int32 texelWidth = packed ? width / 2 : width;
         glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
-        glCheck(m_Functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels));
+        glCheck(m_Functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, texelWidth, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels));
 
         // Updates the vertex-buffer
         m_Buffer = new float[16]
@@ -132,24 +150,31 @@ namespace qboy
             ypos + height > m_Height ||
             xpos < 0 || ypos < 0)
             return;
+        if (m_IsPacked && (xpos % 2 != 0 || width % 2 != 0))
+            return;
+
+        // Packed textures are addressed in bytes of two pixels
+        Int32 texelX = m_IsPacked ? xpos / 2 : xpos;
+        Int32 texelWidth = m_IsPacked ? width / 2 : width;
+        Int32 stride = m_IsPacked ? m_Width / 2 : m_Width;
 
 
         // Updates the pixels of a specific region.
         int pixelInc = 0;
-        for (int y = ypos; y < height; y++)
-            for (int x = xpos; x < width; x++)
-                m_Pixels[x+y*m_Width] = pixels[pixelInc++];
+        for (int y = ypos; y < ypos + height; y++)
+            for (int x = texelX; x < texelX + texelWidth; x++)
+                m_Pixels[x+y*stride] = pixels[pixelInc++];
 
         // Applies the updated data to the current texture
         glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
-        glCheck(m_Functions->glTexSubImage2D(GL_TEXTURE_2D, 0, xpos, ypos, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels));
+        glCheck(m_Functions->glTexSubImage2D(GL_TEXTURE_2D, 0, texelX, ypos, texelWidth, height, GL_RED, GL_UNSIGNED_BYTE, pixels));
     }
 
     ///////////////////////////////////////////////////////////
     void IndexedTexture::updateColor(const GLColor &color, UInt32 index)
     {
-        // Updates only if index is valid
-        if (index > 256)
+        // Updates only if index is valid; bank colors belong to the bank
+        if (index >= 256 || m_Bank || m_Colors.isEmpty())
             return;
 
         // Replaces old color entry
@@ -181,14 +206,18 @@ namespace qboy
         // Specifies the matrix and the buffers within the shader program
         s_ShaderProgram->bind();
         s_ShaderProgram->setUniformValue("uni_mvp", mat_mvp);
+        s_ShaderProgram->setUniformValue("uni_packed", (GLint)(m_IsPacked ? 1 : 0));
+        s_ShaderProgram->setUniformValue("uni_offset", (GLint)m_PaletteOffset);
         s_ShaderProgram->enableAttributeArray(IT_VERTEX_ATTR);
         s_ShaderProgram->enableAttributeArray(IT_COORD_ATTR);
         s_ShaderProgram->setAttributeBuffer(IT_VERTEX_ATTR, GL_FLOAT, 0*sizeof(float), 2, 4*sizeof(float));
         s_ShaderProgram->setAttributeBuffer(IT_COORD_ATTR,  GL_FLOAT, 2*sizeof(float), 2, 4*sizeof(float));
 
-        // Binds the textures to their respective units
+        // Binds the textures to their respective units. All textures
+        // using the same bank also share the same palette texture.
+        UInt32 palette = m_Bank ? m_Bank->texture() : m_PaletteID;
         glCheck(m_Functions->glActiveTexture(GL_TEXTURE1));
-        glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_PaletteID));
+        glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, palette));
         glCheck(m_Functions->glActiveTexture(GL_TEXTURE0));
         glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
 
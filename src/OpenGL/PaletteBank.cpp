@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Graphics/PaletteErrors.hpp>
+#include <QBoy/OpenGL/GLErrors.hpp>
+#include <QBoy/OpenGL/PaletteBank.hpp>
+#include <cstring>
+
+
+namespace qboy
+{
+    ///////////////////////////////////////////////////////////
+    // Definitions
+    //
+    ///////////////////////////////////////////////////////////
+    #define PB_ROW_COLORS       256
+    #define PB_MAX_ROWS         1024    // Minimum texture size of OpenGL 3.3
+    #define PB_MIN_CAPACITY     16
+
+
+    ///////////////////////////////////////////////////////////
+    // Constructor and destructor
+    //
+    ///////////////////////////////////////////////////////////
+    PaletteBank::PaletteBank()
+        : m_Rows(0),
+          m_NextBank(0),
+          m_DirtyFirst(0),
+          m_DirtyLast(0),
+          m_Capacity(0),
+          m_TextureID(0),
+          m_Functions(0)
+    {
+    }
+
+    ///////////////////////////////////////////////////////////
+    PaletteBank::~PaletteBank()
+    {
+        if (m_TextureID != 0)
+            glCheck(m_Functions->glDeleteTextures(1, &m_TextureID));
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    // Member functions
+    //
+    ///////////////////////////////////////////////////////////
+    Int32 PaletteBank::add(const Palette &palette)
+    {
+        const QVector<Color> &colors = palette.raw();
+        if (colors.size() != 16 && colors.size() != PB_ROW_COLORS)
+        {
+            m_LastError = PAL_ERROR_COUNT;
+            return -1;
+        }
+
+        // Fills the open row with 16-color palettes first
+        Int32 offset;
+        if (colors.size() == 16 && m_NextBank % PB_ROW_COLORS != 0)
+        {
+            offset = m_NextBank;
+            m_NextBank += 16;
+        }
+        else
+        {
+            if (m_Rows >= PB_MAX_ROWS)
+            {
+                m_LastError = PAL_ERROR_BANK;
+                return -1;
+            }
+
+            offset = m_Rows * PB_ROW_COLORS;
+            m_Table.resize(++m_Rows * PB_ROW_COLORS);
+
+            if (colors.size() == 16)
+                m_NextBank = offset + 16;
+        }
+
+        update(offset, palette);
+        return offset;
+    }
+
+    ///////////////////////////////////////////////////////////
+    bool PaletteBank::update(Int32 offset, const Palette &palette)
+    {
+        const QVector<Color> &colors = palette.raw();
+        if (offset < 0 || offset % colors.size() != 0 || offset + colors.size() > m_Table.size())
+        {
+            m_LastError = PAL_ERROR_COUNT;
+            return false;
+        }
+
+        // Marks the rows to upload on the next use of the texture
+        std::memcpy(m_Table.data() + offset, colors.constData(), colors.size() * sizeof(Color));
+        Int32 row = offset / PB_ROW_COLORS;
+        if (m_DirtyFirst == m_DirtyLast)
+        {
+            m_DirtyFirst = row;
+            m_DirtyLast = row + 1;
+        }
+        else
+        {
+            m_DirtyFirst = qMin(m_DirtyFirst, row);
+            m_DirtyLast = qMax(m_DirtyLast, row + 1);
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    void PaletteBank::updateColor(Int32 index, const Color &color)
+    {
+        if (index < 0 || index >= m_Table.size())
+            return;
+
+        m_Table[index] = color;
+
+        // Uploads the color right away if the texture holds its row
+        if (m_TextureID != 0 && index / PB_ROW_COLORS < m_Capacity)
+        {
+            glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
+            glCheck(m_Functions->glTexSubImage2D(GL_TEXTURE_2D, 0, index % PB_ROW_COLORS, index / PB_ROW_COLORS, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &color));
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    void PaletteBank::clear()
+    {
+        m_Table.clear();
+        m_Rows = 0;
+        m_NextBank = 0;
+        m_DirtyFirst = 0;
+        m_DirtyLast = 0;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    const QVector<Color> &PaletteBank::table() const
+    {
+        return m_Table;
+    }
+
+    ///////////////////////////////////////////////////////////
+    Int32 PaletteBank::rows() const
+    {
+        return m_Rows;
+    }
+
+    ///////////////////////////////////////////////////////////
+    UInt32 PaletteBank::texture()
+    {
+        if (m_TextureID == 0)
+        {
+            glCheck(m_Functions->glGenTextures(1, &m_TextureID));
+            glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
+            glCheck(m_Functions->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            glCheck(m_Functions->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        }
+
+        // Grows the texture by doubling; uploads the whole table then
+        if (m_Rows > m_Capacity)
+        {
+            m_Capacity = qMax(m_Capacity * 2, PB_MIN_CAPACITY);
+            while (m_Capacity < m_Rows)
+                m_Capacity *= 2;
+
+            glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
+            glCheck(m_Functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, PB_ROW_COLORS, m_Capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+
+            m_DirtyFirst = 0;
+            m_DirtyLast = m_Rows;
+        }
+
+        // Otherwise, uploads the changed rows only
+        if (m_DirtyFirst != m_DirtyLast)
+        {
+            const Color *rows = m_Table.constData() + m_DirtyFirst * PB_ROW_COLORS;
+            glCheck(m_Functions->glBindTexture(GL_TEXTURE_2D, m_TextureID));
+            glCheck(m_Functions->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_DirtyFirst, PB_ROW_COLORS, m_DirtyLast - m_DirtyFirst, GL_RGBA, GL_UNSIGNED_BYTE, rows));
+
+            m_DirtyFirst = 0;
+            m_DirtyLast = 0;
+        }
+
+        return m_TextureID;
+    }
+
+    ///////////////////////////////////////////////////////////
+    const QString &PaletteBank::lastError() const
+    {
+        return m_LastError;
+    }
+
+
+    ///////////////////////////////////////////////////////////
+    void PaletteBank::setOpenGLFunctions(QOpenGLFunctions *functions)
+    {
+        m_Functions = functions;
+    }
+}
@@ -0,0 +1,31 @@
+#
+# QBoy: GameboyAdvance library
+# Copyright (C) 2015-2016 Pokedude
+# License: General Public License 3.0
+#
+
+
+#
+# QMake Settings
+#
+QT         += core concurrent
+QT         -= gui
+TARGET      = CompressionCheck
+TEMPLATE    = app
+CONFIG     += c++11 console
+CONFIG     -= app_bundle
+INCLUDEPATH += ../../include
+
+#
+# Links against the library built from ../../QBoy.pro;
+# override QBOY_LIBDIR if it was built elsewhere.
+#
+isEmpty(QBOY_LIBDIR): QBOY_LIBDIR = $$OUT_PWD/../..
+LIBS += -L$$QBOY_LIBDIR -lQBoy
+
+
+#
+# Source Files
+#
+SOURCES += \
+    main.cpp
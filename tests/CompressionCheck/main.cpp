@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Compression.hpp>
+#include <cstdio>
+
+
+using namespace qboy;
+
+
+///////////////////////////////////////////////////////////
+/// Formats to check, along with their names.
+///
+///////////////////////////////////////////////////////////
+const CompressionType check_types[] =
+{
+    CT_Lz77, CT_Huffman4, CT_Huffman8, CT_Rle, CT_Diff8, CT_Diff16
+};
+
+const char *const check_names[] =
+{
+    "LZ77", "Huffman4", "Huffman8", "RLE", "Diff8", "Diff16"
+};
+
+
+///////////////////////////////////////////////////////////
+/// Generates graphics-like data: runs, repeated rows of
+/// tiles and noise.
+///
+///////////////////////////////////////////////////////////
+QByteArray check_data(Int32 length)
+{
+    QByteArray data(length, '\0');
+    for (Int32 i = 0; i < length;)
+    {
+        Int32 run = 1 + qrand() % 192;
+        Int32 kind = qrand() % 3;
+        for (Int32 j = 0; j < run && i < length; j++, i++)
+        {
+            if (kind == 0)
+                data[i] = static_cast<char>(qrand());
+            else if (kind == 1 && i >= 32)
+                data[i] = data[i - 32];
+            else
+                data[i] = static_cast<char>(run);
+        }
+    }
+
+    return data;
+}
+
+///////////////////////////////////////////////////////////
+/// Encodes the data in every format and decodes it again.
+/// Returns the amount of mismatches.
+///
+///////////////////////////////////////////////////////////
+Int32 check_roundtrip(const char *name, const QByteArray &raw)
+{
+    Int32 failures = 0;
+    for (Int32 i = 0; i < 6; i++)
+    {
+        // 16-bit filters only accept data of whole units
+        QByteArray encoded = Compression::compress(raw, check_types[i]);
+        if (check_types[i] == CT_Diff16 && raw.size() % 2 != 0)
+        {
+            if (!encoded.isNull())
+            {
+                std::printf("%s: %s accepted an odd length\n", name, check_names[i]);
+                failures++;
+            }
+
+            continue;
+        }
+
+        Int32 size = 0;
+        if (encoded.isNull())
+        {
+            std::printf("%s: %s failed to encode %d bytes\n", name, check_names[i], raw.size());
+            failures++;
+        }
+        else if (Compression::decompress(encoded, &size) != raw || size > encoded.size())
+        {
+            std::printf("%s: %s does not decode to %d bytes\n", name, check_names[i], raw.size());
+            failures++;
+        }
+    }
+
+    // The best format must decode as well
+    CompressionType type = CT_None;
+    Int32 size = 0;
+    QByteArray best = Compression::compressBest(raw, &type);
+    if (best.isNull() || Compression::decompress(best, &size) != raw)
+    {
+        std::printf("%s: compressBest does not decode to %d bytes\n", name, raw.size());
+        failures++;
+    }
+
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////
+/// Checks that LZ77, RLE, Huffman and the differential
+/// filters decode their own output, on edge cases and on
+/// random data. Returns non-zero if any output differs.
+///
+///////////////////////////////////////////////////////////
+int main()
+{
+    qsrand(0x51B0);
+    Int32 failures = 0;
+
+    // Edge cases: no data, one byte and runs beyond 130 bytes
+    failures += check_roundtrip("empty", QByteArray(""));
+    failures += check_roundtrip("one byte", QByteArray(1, '\x5A'));
+    failures += check_roundtrip("run of 130", QByteArray(130, '\x11'));
+    failures += check_roundtrip("run of 131", QByteArray(131, '\x22'));
+    failures += check_roundtrip("run of 1000", QByteArray(1000, '\x00'));
+    failures += check_roundtrip("runs and literals", QByteArray(133, '\x33') + QByteArray("\x01\x02\x03") + QByteArray(260, '\x44'));
+
+    // One symbol only, for both 4-bit and 8-bit units
+    failures += check_roundtrip("single symbol", QByteArray(64, '\x77'));
+
+    // Every byte value, once and with a skewed distribution
+    QByteArray values, skewed;
+    for (Int32 i = 0; i < 256; i++)
+    {
+        values.append(static_cast<char>(i));
+        skewed.append(QByteArray(1 + (i < 8 ? 256 >> i : 0), static_cast<char>(i)));
+    }
+
+    failures += check_roundtrip("all byte values", values);
+    failures += check_roundtrip("skewed byte values", skewed);
+
+    // Random lengths, odd ones included
+    for (Int32 round = 0; round < 64; round++)
+    {
+        char name[32];
+        std::sprintf(name, "round %d", round);
+        failures += check_roundtrip(name, check_data(1 + qrand() % 0x4000));
+    }
+
+    std::printf(failures == 0 ? "CompressionCheck passed.\n" : "CompressionCheck failed.\n");
+    return failures == 0 ? 0 : 1;
+}
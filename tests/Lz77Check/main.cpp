@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////
+//
+// QBoy: GameboyAdvance library
+// Copyright (C) 2015-2016 Pokedude
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+///////////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////
+// Include files
+//
+///////////////////////////////////////////////////////////
+#include <QBoy/Core/Lz77.hpp>
+#include <QThreadPool>
+#include <cstdio>
+
+
+using namespace qboy;
+
+
+///////////////////////////////////////////////////////////
+/// Generates graphics-like data: runs, repeated rows of
+/// tiles and noise, so that all encoder paths are taken.
+///
+///////////////////////////////////////////////////////////
+QByteArray check_data(Int32 length)
+{
+    QByteArray data(length, '\0');
+    for (Int32 i = 0; i < length;)
+    {
+        Int32 run = 1 + qrand() % 96;
+        Int32 kind = qrand() % 3;
+        for (Int32 j = 0; j < run && i < length; j++, i++)
+        {
+            if (kind == 0)
+                data[i] = static_cast<char>(qrand());
+            else if (kind == 1 && i >= 32)
+                data[i] = data[i - 32];
+            else
+                data[i] = static_cast<char>(run);
+        }
+    }
+
+    return data;
+}
+
+///////////////////////////////////////////////////////////
+/// Determines whether both checkpoint lists are identical.
+///
+///////////////////////////////////////////////////////////
+bool check_equal(const QVector<Lz77Checkpoint> &a, const QVector<Lz77Checkpoint> &b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (Int32 i = 0; i < a.size(); i++)
+    {
+        if (a[i].input != b[i].input || a[i].output != b[i].output)
+            return false;
+    }
+
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////
+/// Checks the guarantees given by qboy::Lz77::recompress
+/// and qboy::Lz77::compressParallel: both must yield the
+/// exact output of qboy::Lz77::compress. Returns non-zero
+/// on the first mismatch.
+///
+///////////////////////////////////////////////////////////
+int main()
+{
+    qsrand(0x51B0);
+    Int32 failures = 0;
+
+    for (Int32 round = 0; round < 64; round++)
+    {
+        QByteArray raw = check_data(256 + qrand() % 0x8000);
+        QVector<Lz77Checkpoint> checkpoints;
+        QByteArray encoded = Lz77::compress(raw, &checkpoints);
+
+        // Parallel encoding, on one and on all threads
+        QThreadPool *pool = QThreadPool::globalInstance();
+        Int32 threads = pool->maxThreadCount();
+        for (Int32 count : { 1, threads })
+        {
+            QVector<Lz77Checkpoint> parallelPoints;
+            pool->setMaxThreadCount(count);
+            if (Lz77::compressParallel(raw, &parallelPoints) != encoded ||
+                !check_equal(parallelPoints, checkpoints))
+            {
+                std::printf("round %d: compressParallel differs on %d threads\n", round, count);
+                failures++;
+            }
+        }
+
+        pool->setMaxThreadCount(threads);
+
+        // Random edits: single bytes, spans and changed lengths
+        for (Int32 edit = 0; edit < 8; edit++)
+        {
+            QByteArray modified = raw;
+            Int32 position = qrand() % modified.size();
+            Int32 kind = qrand() % 4;
+            if (kind == 0)
+                modified[position] = static_cast<char>(modified[position] ^ (1 + qrand() % 255));
+            else if (kind == 1)
+                modified.replace(position, qrand() % 64, check_data(1 + qrand() % 64));
+            else if (kind == 2)
+                modified.insert(position, check_data(1 + qrand() % 64));
+            else
+                modified.remove(position, 1 + qrand() % 64);
+
+            QVector<Lz77Checkpoint> expectedPoints;
+            QByteArray expected = Lz77::compress(modified, &expectedPoints);
+            QVector<Lz77Checkpoint> updatedPoints = checkpoints;
+            QByteArray result = Lz77::recompress(modified, raw, encoded, &updatedPoints);
+            if (result != expected || !check_equal(updatedPoints, expectedPoints))
+            {
+                std::printf("round %d: recompress differs after edit %d at 0x%X\n", round, kind, position);
+                failures++;
+            }
+
+            if (Lz77::decompress(result, &position) != modified)
+            {
+                std::printf("round %d: recompressed data does not decode\n", round);
+                failures++;
+            }
+
+            // Continues editing from the new version
+            raw = modified;
+            encoded = result;
+            checkpoints = updatedPoints;
+        }
+    }
+
+    std::printf(failures == 0 ? "Lz77Check passed.\n" : "Lz77Check failed.\n");
+    return failures == 0 ? 0 : 1;
+}